@@ -75,6 +75,16 @@ license and credits. */
 #define TEMP_CONTROL_STATIC 1
 #endif
 
+/**
+ * Number of chambers controlled by this board. Each chamber has its own
+ * devices, constants and settings in eeprom. Values above 1 need
+ * TEMP_CONTROL_STATIC, since the chamber state is swapped in and out of the
+ * static TempControl.
+ */
+#ifndef BREWPI_CHAMBER_COUNT
+#define BREWPI_CHAMBER_COUNT 1
+#endif
+
 /**
  * Enable the simulator. Real sensors/actuators are replaced with simulated
  * versions. In particular, the values reported by temp sensors are based on
@@ -88,6 +98,200 @@ license and credits. */
 #define BREWPI_EEPROM_HELPER_COMMANDS BREWPI_DEBUG || BREWPI_SIMULATE
 #endif
 
+/**
+ * Reject single bad sensor readings, like the 85 C power-on value, before
+ * they reach the temperature filters. A reading further than the threshold
+ * (in degrees Celsius) from the median of the last TEMP_SENSOR_OUTLIER_WINDOW
+ * readings is replaced by that median. The window must be odd; 0 disables
+ * the stage.
+ */
+#ifndef TEMP_SENSOR_OUTLIER_WINDOW
+#define TEMP_SENSOR_OUTLIER_WINDOW 3
+#endif
+
+#ifndef TEMP_SENSOR_OUTLIER_THRESHOLD
+#define TEMP_SENSOR_OUTLIER_THRESHOLD 2.0
+#endif
+
+#if TEMP_SENSOR_OUTLIER_WINDOW && TEMP_SENSOR_OUTLIER_WINDOW % 2 == 0
+#error "TEMP_SENSOR_OUTLIER_WINDOW must be odd"
+#endif
+
+/**
+ * Support a least squares fit of the temperature slope, selected with slope
+ * filter settings of 8 and up. The fit is allocated on the heap when it is
+ * selected, 82 bytes per sensor on AVR. With 0, settings of 8 and up use
+ * the slowest slope filter.
+ */
+#ifndef TEMP_SENSOR_SLOPE_REGRESSION
+#define TEMP_SENSOR_SLOPE_REGRESSION 1
+#endif
+
+/**
+ * Detect the peaks of the slow filtered temperature with the hysteresis of
+ * PeakDetector, 19 bytes of RAM per sensor on AVR. With 0, every local
+ * extremum of three samples is a peak, as in older firmware.
+ */
+#ifndef TEMP_SENSOR_PEAK_DETECTOR
+#define TEMP_SENSOR_PEAK_DETECTOR 1
+#endif
+
+/**
+ * Peaks in the fridge temperature, used to tune the overshoot estimators,
+ * are only accepted when the temperature moved back more than the noise band
+ * (in degrees Celsius) and the peak stands out at least the minimum
+ * prominence from the previous valley or top. Setting both to 0 accepts
+ * every local extremum of the filtered temperature.
+ */
+#ifndef PEAK_DETECT_NOISE_BAND
+#define PEAK_DETECT_NOISE_BAND 0.05
+#endif
+
+#ifndef PEAK_DETECT_MIN_PROMINENCE
+#define PEAK_DETECT_MIN_PROMINENCE 0.1
+#endif
+
+/**
+ * Keep a history of the temperatures and state of the selected chamber, so
+ * the script can fill gaps after it reconnects. A sample is taken every
+ * TEMP_HISTORY_INTERVAL seconds and TEMP_HISTORY_SAMPLES samples are kept,
+ * at 4 bytes of RAM each. The default keeps 24 hours in 288 bytes; on an Uno
+ * at most 96 samples are allowed. An 'H' response holds at most
+ * TEMP_HISTORY_PAGE_SIZE samples, unless the script asks for another count.
+ */
+#ifndef BREWPI_TEMP_HISTORY
+#define BREWPI_TEMP_HISTORY 0
+#endif
+
+#ifndef TEMP_HISTORY_INTERVAL
+#define TEMP_HISTORY_INTERVAL 1200
+#endif
+
+#ifndef TEMP_HISTORY_SAMPLES
+#define TEMP_HISTORY_SAMPLES 72
+#endif
+
+#ifndef TEMP_HISTORY_PAGE_SIZE
+#define TEMP_HISTORY_PAGE_SIZE 24
+#endif
+
+/**
+ * Bit mask of the filter coefficients (bit b for b = 0..6) that get filter
+ * code with constant shift counts. On AVR a variable shift of a 32-bit value
+ * is a loop with a counter, constant shifts by whole bytes are moves. Each
+ * bit adds one copy of the filter equation. The default covers the b values
+ * of the default control constants (1, 3 and 4); other values use the
+ * variable shift code. 0 disables the kernels.
+ */
+#ifndef FILTER_CONSTANT_SHIFTS
+#define FILTER_CONSTANT_SHIFTS ((1 << 1) | (1 << 3) | (1 << 4))
+#endif
+
+/**
+ * Changed settings and constants are written to eeprom at the end of each
+ * serial message, or after this many seconds without further changes.
+ */
+#ifndef EEPROM_COMMIT_DELAY
+#define EEPROM_COMMIT_DELAY 5
+#endif
+
+/**
+ * Support the 'f' command, which sends settings, constants, variables,
+ * temperatures and the display in one response, instead of a round trip
+ * for each of them.
+ */
+#ifndef BREWPI_FULL_STATE_COMMAND
+#define BREWPI_FULL_STATE_COMMAND 1
+#endif
+
+/**
+ * Support the compact temperature line with short keys and only changed
+ * values. The host switches to it with the 'm' command; the verbose format
+ * stays the default.
+ */
+#ifndef BREWPI_COMPACT_TELEMETRY
+#define BREWPI_COMPACT_TELEMETRY 1
+#endif
+
+/**
+ * Support telemetry subscriptions with the 'u' command. The firmware then
+ * pushes the temperature line itself at the control tick, when a subscribed
+ * value moved more than the deadband, instead of waiting for 't'. The
+ * flash it takes is printed by tools/size_report.sh --features.
+ */
+#ifndef BREWPI_TELEMETRY_PUSH
+#define BREWPI_TELEMETRY_PUSH 1
+#endif
+
+/**
+ * Support binary frames with a CRC-16 for temperatures, settings, constants,
+ * variables and log messages. The host switches to them with the 'b'
+ * command; JSON stays the default.
+ */
+#ifndef BREWPI_BINARY_PILINK
+#define BREWPI_BINARY_PILINK 0
+#endif
+
+/**
+ * Size in bytes of the queue for serial output, 0 to write to the serial port
+ * directly. With a queue, responses do not wait for the serial port, and log
+ * messages are dropped when they would use the last PILINK_TX_QUEUE_RESERVE
+ * bytes. Other responses are never dropped. The statistics are requested with
+ * the 'q' command.
+ */
+#ifndef PILINK_TX_QUEUE_SIZE
+#define PILINK_TX_QUEUE_SIZE 0
+#endif
+
+#ifndef PILINK_TX_QUEUE_RESERVE
+#define PILINK_TX_QUEUE_RESERVE (PILINK_TX_QUEUE_SIZE / 4)
+#endif
+
+/**
+ * Log messages with the same type and ID are limited to LOG_RATE_LIMIT per
+ * LOG_RATE_PERIOD seconds, so a flapping sensor cannot flood the serial
+ * link. The INFO_RECEIVED_SETTING of each setting in an upload is not
+ * limited. The number of suppressed messages is logged when the period
+ * ends. LOG_RATE_SLOTS IDs are tracked at a time, 7 bytes of RAM each on
+ * AVR; messages of other IDs are suppressed and counted while all slots are
+ * in use. A limit of 0 disables this and removes the slots.
+ */
+#ifndef LOG_RATE_LIMIT
+#define LOG_RATE_LIMIT 10
+#endif
+
+#ifndef LOG_RATE_PERIOD
+#define LOG_RATE_PERIOD 60
+#endif
+
+#ifndef LOG_RATE_SLOTS
+#define LOG_RATE_SLOTS 4
+#endif
+
+/**
+ * Number of log messages kept in RAM until the serial port is idle, 0 to
+ * send them immediately. Each takes LOG_RECORD_SIZE bytes; longer string
+ * arguments are truncated. When the queue is full, messages are dropped and
+ * counted. The INFO_RECEIVED_SETTING replies to a settings upload are sent
+ * right away.
+ */
+#ifndef LOG_QUEUE_SIZE
+#define LOG_QUEUE_SIZE 4
+#endif
+
+#ifndef LOG_RECORD_SIZE
+#define LOG_RECORD_SIZE 32
+#endif
+
+/**
+ * Measure the execution time of each stage of the control loop. The
+ * statistics are sent with the 'p' command, with the task statistics
+ * of the scheduler.
+ */
+#ifndef BREWPI_LOOP_PROFILER
+#define BREWPI_LOOP_PROFILER 0
+#endif
+
 #ifndef OPTIMIZE_GLOBAL
 #define OPTIMIZE_GLOBAL 1
 #endif
@@ -31,17 +31,23 @@ license and credits. */
 #include "Ticks.h"
 #include "Display.h"
 #include "TempControl.h"
+#include "ChamberManager.h"
 #include "PiLink.h"
 #include "TempSensor.h"
 #include "FanControl.h"
 // #include "HumiditySensor.h"
 #include "TempSensorMock.h"
 #include "TempSensorExternal.h"
+#include "OneWireTempSensor.h"
 #include "Ticks.h"
 #include "Sensor.h"
 #include "SettingsManager.h"
+#include "EepromManager.h"
 #include "UI.h"
 #include "RotaryEncoder.h"
+#include "Scheduler.h"
+#include "LoopProfiler.h"
+#include "TempHistory.h"
 #include <avr/wdt.h>
 #include "DHT.h"
 
@@ -71,13 +77,16 @@ DelayImpl wait = DelayImpl(DELAY_IMPL_CONFIG);
 ValueActuator alarm;
 UI ui;
 
+// Unit tests built with the firmware sources provide their own setup() and loop()
+#ifndef PIO_UNIT_TESTING
 void setup()
 {
     ui.init();
     piLink.init();
 
     // logDebug("started");
-    tempControl.init();
+    ChamberManager::init();
+    FOR_EACH_CHAMBER(init);
     settingsManager.loadSettings();
 
     // humiditySensor.init();
@@ -106,53 +115,124 @@ void setup()
 
     // logDebug("init complete");
 }
+#endif
 
-void brewpiLoop(void)
+// Scheduled tasks. The control stages are released every second in a fixed
+// order (staggered phase), so the filters and PID keep their 1 s sample time.
+// Slow I/O (LCD) is released half way between control ticks.
+
+static void updateSensorsTask(void)
 {
-    static unsigned long lastUpdate = -1000;  // init at -1000 to update immediately
-    uint8_t oldState;
-    ui.ticks();
+    // All sensors of all chambers are read, then the next conversion is started on each bus.
+    PROFILE_STAGE(PROFILE_UPDATE_TEMPERATURES,
+                  FOR_EACH_CHAMBER(updateTemperatures);
+                  OneWireConversionManager::requestConversions());
+    PROFILE_STAGE(PROFILE_DETECT_PEAKS, FOR_EACH_CHAMBER(detectPeaks));
+}
+
+static void updatePIDTask(void)
+{
+    PROFILE_STAGE(PROFILE_UPDATE_PID, FOR_EACH_CHAMBER(updatePID));
+}
+
+static void updateStateTask(void)
+{
+    uint8_t oldState = tempControl.getState();
+    PROFILE_STAGE(PROFILE_UPDATE_STATE, FOR_EACH_CHAMBER(updateState));
+    if (oldState != tempControl.getState())
+    {
+        piLink.printTemperatures(); // add a data point at every state transition of the selected chamber
+    }
+#if BREWPI_TELEMETRY_PUSH
+    piLink.pushTelemetry(); // samples of a subscription are taken at the control tick
+#endif
+    PROFILE_STAGE(PROFILE_UPDATE_OUTPUTS, FOR_EACH_CHAMBER(updateOutputs));
+#if BREWPI_TEMP_HISTORY
+    TempHistory::update();
+#endif
+}
 
+static void updateDisplayTask(void)
+{
     // Reset display on timer to mitigate screen scramble
-    #if BREWPI_LCD && LCD_RESET_PERIOD
-        static unsigned long lastLcdUpdate = 0;  // Counter for LCD reset
-        if (ticks.seconds() - lastLcdUpdate >= LCD_RESET_PERIOD)
-        {
-            lastLcdUpdate = ticks.seconds();
-
-            display.init();
-            display.printStationaryText();
-            display.printState();
-
-            
-            #ifdef BREWPI_ROTARY_ENCODER
-            rotaryEncoder.init();
-            #endif
-        }
-    #endif
-
-    if (!ui.inStartup() && (ticks.millis() - lastUpdate >= (1000)))
-    { //update settings every second
-        lastUpdate = ticks.millis();
-
-        tempControl.updateTemperatures();
-        tempControl.detectPeaks();
-        tempControl.updatePID();
-        oldState = tempControl.getState();
-        tempControl.updateState();
-        if (oldState != tempControl.getState())
-        {
-            piLink.printTemperatures(); // add a data point at every state transition
-        }
-        tempControl.updateOutputs();
-
-        ui.update();
+#if BREWPI_LCD && LCD_RESET_PERIOD
+    static unsigned long lastLcdUpdate = 0; // Counter for LCD reset
+    if (ticks.seconds() - lastLcdUpdate >= LCD_RESET_PERIOD)
+    {
+        lastLcdUpdate = ticks.seconds();
+
+        display.init();
+        display.printStationaryText();
+
+#ifdef BREWPI_ROTARY_ENCODER
+        rotaryEncoder.init();
+#endif
     }
+#endif
+    PROFILE_STAGE(PROFILE_UI_UPDATE, ui.update());
+}
+
+static void updateBacklightTask(void)
+{
+    display.updateBacklight();
+}
 
-    //listen for incoming serial connections while waiting to update
-    piLink.receive();
+static void commitSettingsTask(void)
+{
+    eepromManager.commitTempSettingsWhenQuiet();
 }
 
+static void receiveSerialTask(void)
+{
+    PROFILE_STAGE(PROFILE_PILINK_RECEIVE, piLink.receive());
+}
+
+// The order of the statistics in the 'p' response
+enum BrewpiTasks
+{
+    TASK_SENSORS,
+    TASK_PID,
+    TASK_STATE,
+    TASK_DISPLAY,
+    TASK_BACKLIGHT,
+    TASK_EEPROM,
+    TASK_SERIAL,
+    NUM_TASKS
+};
+
+// Periods must be non-zero. Phase and deadline are in milliseconds.
+static const ScheduledTask brewpiTasks[NUM_TASKS] PROGMEM = {
+    /* TASK_SENSORS */ {updateSensorsTask, 1000, 0, 100},
+    /* TASK_PID */ {updatePIDTask, 1000, 1, 150},
+    /* TASK_STATE */ {updateStateTask, 1000, 2, 200},
+    /* TASK_DISPLAY */ {updateDisplayTask, 1000, 500, 500},
+    /* TASK_BACKLIGHT */ {updateBacklightTask, 250, 0, 250},
+    /* TASK_EEPROM */ {commitSettingsTask, 1000, 750, 1000},
+    /* TASK_SERIAL */ {receiveSerialTask, 5, 0, 5},
+};
+
+TaskStats brewpiTaskStats[NUM_TASKS];
+const uint8_t brewpiTaskCount = NUM_TASKS;
+
+void brewpiLoop(void)
+{
+    static bool started = false;
+    ui.ticks();
+
+    if (ui.inStartup())
+    {
+        piLink.receive();
+        return;
+    }
+    if (!started)
+    {
+        Scheduler::start(brewpiTasks, brewpiTaskStats, NUM_TASKS);
+        started = true;
+    }
+    Scheduler::run(brewpiTasks, brewpiTaskStats, NUM_TASKS);
+}
+
+#ifndef PIO_UNIT_TESTING
 void loop()
 {
 #if BREWPI_SIMULATE
@@ -161,3 +241,4 @@ void loop()
     brewpiLoop();
 #endif
 }
+#endif
@@ -0,0 +1,143 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "ChamberManager.h"
+
+#if BREWPI_CHAMBER_COUNT > 1
+
+TempControlState ChamberManager::chambers[BREWPI_CHAMBER_COUNT];
+chamber_id ChamberManager::current;
+chamber_id ChamberManager::selected;
+
+void TempControlState::save()
+{
+	beerSensor = TempControl::beerSensor;
+	fridgeSensor = TempControl::fridgeSensor;
+	fridgeHumidity = TempControl::fridgeHumidity;
+	ambientSensor = TempControl::ambientSensor;
+	heater = TempControl::heater;
+	cooler = TempControl::cooler;
+	light = TempControl::light;
+	fan = TempControl::fan;
+	door = TempControl::door;
+
+	cc = TempControl::cc;
+	cs = TempControl::cs;
+	cv = TempControl::cv;
+
+	storedBeerSetting = TempControl::storedBeerSetting;
+
+	lastIdleTime = TempControl::lastIdleTime;
+	lastHeatTime = TempControl::lastHeatTime;
+	lastCoolTime = TempControl::lastCoolTime;
+	waitTime = TempControl::waitTime;
+
+	state = TempControl::state;
+	doPosPeakDetect = TempControl::doPosPeakDetect;
+	doNegPeakDetect = TempControl::doNegPeakDetect;
+	doorOpen = TempControl::doorOpen;
+	integralUpdateCounter = TempControl::integralUpdateCounter;
+}
+
+void TempControlState::restore()
+{
+	TempControl::beerSensor = beerSensor;
+	TempControl::fridgeSensor = fridgeSensor;
+	TempControl::fridgeHumidity = fridgeHumidity;
+	TempControl::ambientSensor = ambientSensor;
+	TempControl::heater = heater;
+	TempControl::cooler = cooler;
+	TempControl::light = light;
+	TempControl::fan = fan;
+	TempControl::door = door;
+
+	TempControl::cc = cc;
+	TempControl::cs = cs;
+	TempControl::cv = cv;
+
+	TempControl::storedBeerSetting = storedBeerSetting;
+
+	TempControl::lastIdleTime = lastIdleTime;
+	TempControl::lastHeatTime = lastHeatTime;
+	TempControl::lastCoolTime = lastCoolTime;
+	TempControl::waitTime = waitTime;
+
+	TempControl::state = state;
+	TempControl::doPosPeakDetect = doPosPeakDetect;
+	TempControl::doNegPeakDetect = doNegPeakDetect;
+	TempControl::doorOpen = doorOpen;
+	TempControl::integralUpdateCounter = integralUpdateCounter;
+}
+
+void ChamberManager::init()
+{
+	// TempControl still holds the unconfigured defaults, use them for all chambers.
+	for (chamber_id id = 0; id < BREWPI_CHAMBER_COUNT; id++)
+	{
+		chambers[id].save();
+	}
+	current = 0;
+	selected = 0;
+}
+
+chamber_id ChamberManager::switchChamber(chamber_id id)
+{
+	chamber_id previous = current;
+	if (id != current && id < BREWPI_CHAMBER_COUNT)
+	{
+		chambers[current].save();
+		chambers[id].restore();
+		current = id;
+	}
+	return previous;
+}
+
+bool ChamberManager::selectChamber(chamber_id id)
+{
+	if (id >= BREWPI_CHAMBER_COUNT)
+	{
+		return false;
+	}
+	selected = id;
+	switchChamber(id);
+	return true;
+}
+
+void ChamberManager::forEachChamber(void (*stage)(void))
+{
+	for (chamber_id id = 0; id < BREWPI_CHAMBER_COUNT; id++)
+	{
+		switchChamber(id);
+		stage();
+	}
+	switchChamber(selected);
+}
+
+#endif
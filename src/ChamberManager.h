@@ -0,0 +1,158 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TempControl.h"
+
+typedef uint8_t chamber_id;
+
+#if BREWPI_CHAMBER_COUNT > 1
+
+#if !TEMP_CONTROL_STATIC
+#error "BREWPI_CHAMBER_COUNT > 1 requires TEMP_CONTROL_STATIC"
+#endif
+
+#if BREWPI_CHAMBER_COUNT > 4
+#error "BREWPI_CHAMBER_COUNT is larger than the chambers reserved in eeprom"
+#endif
+
+/*
+ * The per-chamber part of TempControl. The chamber that is being controlled
+ * is copied into the static TempControl fields, so the control code itself
+ * keeps using compile-time resolvable memory references.
+ */
+class TempControlState
+{
+  public:
+	void save();	// copy the static TempControl state into this chamber
+	void restore(); // make this chamber the one TempControl works on
+
+  private:
+	TempSensor *beerSensor;
+	TempSensor *fridgeSensor;
+	HumiditySensor *fridgeHumidity;
+	BasicTempSensor *ambientSensor;
+	Actuator *heater;
+	Actuator *cooler;
+	Actuator *light;
+	Actuator *fan;
+	Sensor<bool> *door;
+
+	ControlConstants cc;
+	ControlSettings cs;
+	ControlVariables cv;
+
+	temperature storedBeerSetting;
+
+	tcduration_t lastIdleTime;
+	tcduration_t lastHeatTime;
+	tcduration_t lastCoolTime;
+	tcduration_t waitTime;
+
+	states state;
+	bool doPosPeakDetect;
+	bool doNegPeakDetect;
+	bool doorOpen;
+	uint8_t integralUpdateCounter;
+};
+
+/*
+ * Keeps the state of each chamber and swaps it into TempControl.
+ * Chamber ids are 0-based here; the serial protocol and DeviceConfig use
+ * 1-based ids, with 0 meaning no chamber.
+ *
+ * The selected chamber is the one the serial commands and the display act
+ * on. Outside of forEachChamber() and a ChamberScope, it is always the
+ * chamber loaded in TempControl.
+ */
+class ChamberManager
+{
+  public:
+	// Must be called before TempControl is initialized, so every chamber starts with the unconfigured devices.
+	static void init();
+
+	static chamber_id chamberCount() { return BREWPI_CHAMBER_COUNT; }
+	static chamber_id currentChamber() { return current; }
+	static chamber_id selectedChamber() { return selected; }
+
+	static bool selectChamber(chamber_id id);
+
+	// Loads the given chamber in TempControl and returns the chamber that was loaded before.
+	static chamber_id switchChamber(chamber_id id);
+
+	// Runs a TempControl stage for all chambers, then reloads the selected chamber.
+	static void forEachChamber(void (*stage)(void));
+
+  private:
+	static TempControlState chambers[BREWPI_CHAMBER_COUNT];
+	static chamber_id current;
+	static chamber_id selected;
+};
+
+/*
+ * Loads a chamber in TempControl for the lifetime of this object.
+ */
+class ChamberScope
+{
+  public:
+	ChamberScope(chamber_id id) : previous(ChamberManager::switchChamber(id)) {}
+	~ChamberScope() { ChamberManager::switchChamber(previous); }
+
+  private:
+	chamber_id previous;
+};
+
+// Runs a TempControl stage, e.g. FOR_EACH_CHAMBER(updatePID)
+#define FOR_EACH_CHAMBER(stage) ChamberManager::forEachChamber(&TempControl::stage)
+
+#else
+
+// With a single chamber, TempControl holds the only chamber and everything below compiles away.
+class ChamberManager
+{
+  public:
+	static void init() {}
+	static chamber_id chamberCount() { return 1; }
+	static chamber_id currentChamber() { return 0; }
+	static chamber_id selectedChamber() { return 0; }
+	static bool selectChamber(chamber_id id) { return id == 0; }
+	static chamber_id switchChamber(chamber_id id) { return 0; }
+};
+
+class ChamberScope
+{
+  public:
+	ChamberScope(chamber_id id) {}
+};
+
+#define FOR_EACH_CHAMBER(stage) tempControl.stage()
+
+#endif
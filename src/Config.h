@@ -216,6 +216,18 @@ license and credits. */
 //
 //////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Number of chambers controlled by this board (max 4). Chambers are
+// selected over serial with j{"chamber":n}. Each chamber costs about
+// 100 bytes of RAM.
+//
+// #ifndef BREWPI_CHAMBER_COUNT
+// #define BREWPI_CHAMBER_COUNT 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////
 //
 // Flag to control use of Fast digital pin functions
@@ -259,6 +271,172 @@ license and credits. */
 //
 //////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Keep a temperature history for the script to fill gaps after it
+// reconnects. Each sample takes 4 bytes of RAM, an Uno fits at most 96.
+//
+// #ifndef BREWPI_TEMP_HISTORY
+// #define BREWPI_TEMP_HISTORY 1
+// #endif
+//
+// #ifndef TEMP_HISTORY_INTERVAL
+// #define TEMP_HISTORY_INTERVAL 1200
+// #endif
+//
+// #ifndef TEMP_HISTORY_SAMPLES
+// #define TEMP_HISTORY_SAMPLES 72
+// #endif
+//
+// #ifndef TEMP_HISTORY_PAGE_SIZE
+// #define TEMP_HISTORY_PAGE_SIZE 24
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Replace sensor readings further than the threshold (in C) from the median
+// of the last readings. A window of 5 also removes two bad readings in a
+// row; 0 disables the outlier stage.
+//
+// #ifndef TEMP_SENSOR_OUTLIER_WINDOW
+// #define TEMP_SENSOR_OUTLIER_WINDOW 3
+// #endif
+//
+// #ifndef TEMP_SENSOR_OUTLIER_THRESHOLD
+// #define TEMP_SENSOR_OUTLIER_THRESHOLD 2.0
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Let slope filter settings of 8 and up select a least squares fit of the
+// temperature slope over 4 * setting seconds. Uses heap when selected;
+// disable to save flash.
+//
+// #ifndef TEMP_SENSOR_SLOPE_REGRESSION
+// #define TEMP_SENSOR_SLOPE_REGRESSION 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Only accept fridge temperature peaks that stand out from the noise. 0
+// accepts every local extremum, like older firmware, and saves flash and RAM.
+//
+// #ifndef TEMP_SENSOR_PEAK_DETECTOR
+// #define TEMP_SENSOR_PEAK_DETECTOR 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Bit mask of the filter coefficients (b = 0..6) that get filter code with
+// constant shift counts. Faster, each bit adds one copy of the filter
+// equation. Default: b = 1, 3 and 4.
+//
+// #ifndef FILTER_CONSTANT_SHIFTS
+// #define FILTER_CONSTANT_SHIFTS 0x7F
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Seconds without further changes before changed settings and constants
+// are written to eeprom. Settings received over serial are written at the
+// end of each message.
+//
+// #ifndef EEPROM_COMMIT_DELAY
+// #define EEPROM_COMMIT_DELAY 5
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Support the 'f' command, which sends the settings, constants, variables,
+// temperatures and display in one response. Disable to save flash.
+//
+// #ifndef BREWPI_FULL_STATE_COMMAND
+// #define BREWPI_FULL_STATE_COMMAND 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Support the compact temperature line with short keys and only changed
+// values, selected at runtime with the 'm' command. Disable to save flash.
+//
+// #ifndef BREWPI_COMPACT_TELEMETRY
+// #define BREWPI_COMPACT_TELEMETRY 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Let the host subscribe to temperature lines pushed at the control tick
+// with the 'u' command, instead of polling with 't'. Disable to save flash.
+//
+// #ifndef BREWPI_TELEMETRY_PUSH
+// #define BREWPI_TELEMETRY_PUSH 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Queue serial output, so responses do not wait for the serial port. Log
+// messages are dropped when the queue is nearly full. Uses the queue size
+// in RAM.
+//
+// #ifndef PILINK_TX_QUEUE_SIZE
+// #define PILINK_TX_QUEUE_SIZE 256
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Keep log messages in RAM until the serial port is idle, so they never
+// delay other responses. Uses LOG_QUEUE_SIZE * LOG_RECORD_SIZE bytes of RAM.
+//
+// #ifndef LOG_QUEUE_SIZE
+// #define LOG_QUEUE_SIZE 4
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Support binary frames with a CRC-16 instead of JSON for temperatures,
+// settings, constants, variables and log messages, selected at runtime
+// with the 'b' command.
+//
+// #ifndef BREWPI_BINARY_PILINK
+// #define BREWPI_BINARY_PILINK 0
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Measure the execution time of each stage of the control loop. The
+// statistics are sent with the 'p' command, with the task statistics
+// of the scheduler.
+//
+// #ifndef BREWPI_LOOP_PROFILER
+// #define BREWPI_LOOP_PROFILER 0
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////
 //
 // #ifndef BREWPI_EEPROM_HELPER_COMMANDS
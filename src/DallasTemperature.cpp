@@ -481,8 +481,8 @@ bool DallasTemperature::isConversionAvailable(const uint8_t *deviceAddress)
 }
 #endif
 
-#if REQUIRESWHOLEBUSOPS
 // sends command for all devices on the bus to perform a temperature conversion
+// (skip ROM, so no device is addressed individually)
 
 void DallasTemperature::requestTemperatures()
 {
@@ -497,7 +497,6 @@ void DallasTemperature::requestTemperatures()
     blockTillConversionComplete(getResolution(), NULL);
 #endif
 }
-#endif // REQUIRESWHOLEBUSOPS
 
 // sends command for one device to perform a temperature by address
 
@@ -515,7 +514,6 @@ void DallasTemperature::requestTemperaturesByAddress(const uint8_t *deviceAddres
 #endif
 }
 
-#if REQUIRESWAITFORCONVERSION
 // returns number of milliseconds to wait till conversion is complete (based on IC datasheet)
 
 int16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution)
@@ -537,6 +535,7 @@ int16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution)
 #endif
 }
 
+#if REQUIRESWAITFORCONVERSION
 // Continue to check if the IC has responded with a temperature
 
 void DallasTemperature::blockTillConversionComplete(uint8_t bitResolution, const uint8_t *deviceAddress)
@@ -234,10 +234,11 @@ public:
 
 #endif
 
-#if REQUIRESWHOLEBUSOPS
   // sends command for all devices on the bus to perform a temperature conversion
   void requestTemperatures(void);
-#endif
+
+  // returns number of milliseconds to wait till conversion is complete (based on IC datasheet)
+  static int16_t millisToWaitForConversion(uint8_t);
 
   // sends command for one device to perform a temperature conversion by address
   void requestTemperaturesByAddress(const uint8_t *);
@@ -386,7 +387,6 @@ private:
   int16_t calculateTemperature(const uint8_t *, uint8_t *);
 
 #if REQUIRESWAITFORCONVERSION
-  int16_t millisToWaitForConversion(uint8_t);
   void blockTillConversionComplete(uint8_t, const uint8_t *);
 #endif
 
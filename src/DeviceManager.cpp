@@ -31,6 +31,7 @@ license and credits. */
 #include "BrewpiStrings.h"
 #include "DeviceManager.h"
 #include "TempControl.h"
+#include "ChamberManager.h"
 #include "FanControl.h"
 #include "HumiditySensor.h"
 #include "Actuator.h"
@@ -77,15 +78,18 @@ bool DeviceManager::isDefaultTempSensor(BasicTempSensor *sensor)
  */
 void DeviceManager::setupUnconfiguredDevices()
 {
-	// right now, uninstall doesn't care about chamber/beer distinction.
+	// right now, uninstall doesn't care about beer distinction.
 	// but this will need to match beer/function when multiferment is available
 	DeviceConfig cfg;
-	cfg.chamber = 1;
 	cfg.beer = 1;
-	for (uint8_t i = 0; i < DEVICE_MAX; i++)
+	for (uint8_t c = 1; c <= ChamberManager::chamberCount(); c++)
 	{
-		cfg.deviceFunction = DeviceFunction(i);
-		uninstallDevice(cfg);
+		cfg.chamber = c;
+		for (uint8_t i = 0; i < DEVICE_MAX; i++)
+		{
+			cfg.deviceFunction = DeviceFunction(i);
+			uninstallDevice(cfg);
+		}
 	}
 }
 
@@ -163,12 +167,12 @@ void DeviceManager::disposeDevice(DeviceType dt, void *device)
  * Returns the pointer to where the device pointer resides. This can be used to delete the current device and install a new one. 
  * For Temperature sensors, the returned pointer points to a TempSensor*. The basic device can be fetched by calling
  * TempSensor::getSensor().
+ * The pointer is only valid while the chamber of the device is loaded in TempControl, see chamberOf().
  */
 inline void **deviceTarget(DeviceConfig &config)
 {
-	// for multichamber, will write directly to the multi-chamber managed storage.
-	// later...
-	if (config.chamber > 1 || config.beer > 1)
+	// each chamber controls a single beer for now.
+	if (config.chamber > ChamberManager::chamberCount() || config.beer > 1)
 		return NULL;
 
 	void **ppv;
@@ -207,6 +211,12 @@ inline void **deviceTarget(DeviceConfig &config)
 	return ppv;
 }
 
+// The chamber to load before accessing the device target. Devices that don't belong to a chamber use the loaded one.
+inline chamber_id chamberOf(DeviceConfig &config)
+{
+	return config.chamber ? config.chamber - 1 : ChamberManager::currentChamber();
+}
+
 // A pointer to a "temp sensor" may be a TempSensor* or a BasicTempSensor* . 
 // These functions allow uniform treatment.
 inline bool isBasicSensor(DeviceFunction function)
@@ -235,6 +245,7 @@ inline void setSensor(DeviceFunction f, void **ppv, BasicTempSensor *sensor)
  */
 void DeviceManager::uninstallDevice(DeviceConfig &config)
 {
+	ChamberScope scope(chamberOf(config));
 	void **ppv = deviceTarget(config);
 	if (ppv == NULL)
 		return;
@@ -288,6 +299,7 @@ void DeviceManager::uninstallDevice(DeviceConfig &config)
 void DeviceManager::installDevice(DeviceConfig &config)
 {
 	DeviceType dt = deviceType(config.deviceFunction);
+	ChamberScope scope(chamberOf(config));
 	void **ppv = deviceTarget(config);
 	if (ppv == NULL || config.hw.deactivate)
 		return;
@@ -414,12 +426,22 @@ void assignIfSet(int8_t value, uint8_t *target)
  * Updates the device definition. Only changes that result in a valid device, with no conflicts with other devices
  * are allowed. 
  */
+// The stream for the reply of the command that is parsing its JSON argument.
+static Stream *deviceOutput;
+
 void DeviceManager::parseDeviceDefinition(Stream &p)
 {
 	static DeviceDefinition dev;
 	fill((int8_t *)&dev, sizeof(dev));
+	deviceOutput = &p;
 
-	piLink.parseJson(&handleDeviceDefinition, &dev);
+	piLink.parseJson(&handleDeviceDefinition, &dev, &deviceDefinitionParsed);
+}
+
+void DeviceManager::deviceDefinitionParsed(void *data)
+{
+	DeviceDefinition &dev = *(DeviceDefinition *)data;
+	Stream &p = *deviceOutput;
 
 	if (!inRangeInt8(dev.id, 0, MAX_DEVICE_SLOT)) // no device id given, or it's out of range, can't do anything else.
 		return;
@@ -914,22 +936,30 @@ void DeviceManager::enumerateOneWireDevices(EnumerateHardware &h, EnumDevicesCal
 
 void DeviceManager::enumerateHardwareToStream(Stream &p)
 {
-	EnumerateHardware spec;
+	static EnumerateHardware spec;
 	// set up defaults
 	spec.unused = 0;	// list all devices
 	spec.values = 0;	// don't list values
 	spec.pin = -1;		// any pin
 	spec.hardware = -1; // any hardware
 	spec.function = 0;  // no function restriction
+	deviceOutput = &p;
+
+	piLink.parseJson(handleHardwareSpec, &spec, &hardwareSpecParsed);
+}
 
-	piLink.parseJson(handleHardwareSpec, &spec);
+void DeviceManager::hardwareSpecParsed(void *data)
+{
+	EnumerateHardware &spec = *(EnumerateHardware *)data;
 	DeviceCallbackInfo info;
-	info.data = &p;
+	info.data = deviceOutput;
 
 	// logDebug("Enumerating Hardware");
 
+	piLink.openListResponse('h');
 	firstDeviceOutput = true;
 	enumerateHardware(spec, OutputEnumeratedDevices, &info);
+	piLink.closeListResponse();
 	// logDebug("Enumerating Hardware Complete");
 }
 
@@ -963,6 +993,7 @@ void UpdateDeviceState(DeviceDisplay &dd, DeviceConfig &dc, char *val)
 	if (dt == DEVICETYPE_NONE)
 		return;
 
+	ChamberScope scope(chamberOf(dc));
 	void **ppv = deviceTarget(dc);
 	if (ppv == NULL)
 		return;
@@ -1000,28 +1031,38 @@ void UpdateDeviceState(DeviceDisplay &dd, DeviceConfig &dc, char *val)
 
 void DeviceManager::listDevices(Stream &p)
 {
-	DeviceConfig dc;
-	DeviceDisplay dd;
+	static DeviceDisplay dd;
 	fill((int8_t *)&dd, sizeof(dd));
 	dd.empty = 0;
-	piLink.parseJson(HandleDeviceDisplay, (void *)&dd);
+	deviceOutput = &p;
+	piLink.parseJson(HandleDeviceDisplay, (void *)&dd, &deviceDisplayParsed);
+}
+
+void DeviceManager::deviceDisplayParsed(void *data)
+{
+	DeviceDisplay &dd = *(DeviceDisplay *)data;
+	DeviceConfig dc;
+	piLink.openListResponse('d');
 	if (dd.id == -2)
 	{
 		if (dd.write >= 0)
 			tempControl.cameraLight.setActive(dd.write != 0);
-		return;
 	}
-	deviceManager.beginDeviceOutput();
-	for (device_slot_t idx = 0; deviceManager.allDevices(dc, idx); idx++)
+	else
 	{
-		if (deviceManager.enumDevice(dd, dc, idx))
+		deviceManager.beginDeviceOutput();
+		for (device_slot_t idx = 0; deviceManager.allDevices(dc, idx); idx++)
 		{
-			char val[10];
-			val[0] = 0;
-			UpdateDeviceState(dd, dc, val);
-			deviceManager.printDevice(idx, dc, val, p);
+			if (deviceManager.enumDevice(dd, dc, idx))
+			{
+				char val[10];
+				val[0] = 0;
+				UpdateDeviceState(dd, dc, val);
+				deviceManager.printDevice(idx, dc, val, *deviceOutput);
+			}
 		}
 	}
+	piLink.closeListResponse();
 }
 
 /**
@@ -360,6 +360,11 @@ class DeviceManager
 
 	static OneWire *oneWireBus(uint8_t pin);
 
+	// Called when the JSON argument of the command has been received
+	static void deviceDefinitionParsed(void *data);
+	static void hardwareSpecParsed(void *data);
+	static void deviceDisplayParsed(void *data);
+
 	static bool firstDeviceOutput;
 };
 
@@ -287,20 +287,22 @@ void LcdDisplay::printState(void)
 	if (time != UINT16_MAX)
 	{
 		char timeString[10];
-#if DISPLAY_TIME_HMS // 96 bytes more space required.
+#if DISPLAY_TIME_HMS // a little more code than seconds only
 		unsigned int minutes = time / 60;
 		unsigned int hours = minutes / 60;
-		int stringLength = sprintf_P(timeString, PSTR("%dh%02dm%02d"), hours, minutes % 60, time % 60);
-		char *printString = timeString;
-		if (!hours)
+		char *end = timeString;
+		if (hours)
 		{
-			printString = &timeString[2];
-			stringLength = stringLength - 2;
+			end = uintToString(end, hours, 1);
+			*end++ = 'h';
 		}
-		printAt(20 - stringLength, 3, printString);
+		end = uintToString(end, minutes % 60, 2);
+		*end++ = 'm';
+		end = uintToString(end, time % 60, 2);
+		printAt(20 - (end - timeString), 3, timeString);
 #else
-		int stringLength = sprintf_P(timeString, STR_FMT_U, (unsigned int)time);
-		printAt(20 - stringLength, 3, timeString);
+		char *end = uintToString(timeString, time, 1);
+		printAt(20 - (end - timeString), 3, timeString);
 #endif
 	}
 }
\ No newline at end of file
@@ -39,10 +39,18 @@ struct ChamberSettings
 	uint8_t reserved[1]; // was 3, but added pidMax
 };
 
+/*
+ * Until more than one beer per chamber is supported, the beer blocks of a chamber form a journal
+ * of its settings. Each store goes to the block after the newest one, so the writes are spread
+ * over all blocks. A record is valid when check matches, and the valid record with the highest
+ * sequence (modulo 256) is loaded. Data from before the journal has no valid record and is read
+ * from beer 0.
+ */
 struct BeerBlock
 {
 	ControlSettings cs;
-	uint8_t reserved[2];
+	uint8_t sequence; // was reserved
+	uint8_t check;	  // inverted crc8 of cs and sequence
 };
 
 struct ChamberBlock
@@ -32,12 +32,20 @@ license and credits. */
 
 #include "EepromManager.h"
 #include "TempControl.h"
+#include "ChamberManager.h"
 #include "EepromFormat.h"
 #include "PiLink.h"
+#include "OneWire.h"
 
 EepromManager eepromManager;
 EepromAccess eepromAccess;
 
+uint16_t EepromManager::storeRequests;
+uint16_t EepromManager::storeCommits;
+uint8_t EepromManager::dirtyConstants;
+uint8_t EepromManager::dirtySettings;
+ticks_seconds_t EepromManager::lastStoreRequest;
+
 #define pointerOffset(x) offsetof(EepromFormat, x)
 
 EepromManager::EepromManager()
@@ -74,21 +82,20 @@ void EepromManager::initializeEeprom()
 	{
 		eptr_t pv = pointerOffset(chambers) + (c * sizeof(ChamberBlock));
 		tempControl.storeConstants(pv + offsetof(ChamberBlock, chamberSettings.cc));
-		pv += offsetof(ChamberBlock, beer) + offsetof(BeerBlock, cs);
-		for (uint8_t b = 0; b < ChamberBlock::MAX_BEERS; b++)
-		{
-			//			logDeveloper(PSTR("EepromManager - saving settings for beer %d at %d"), b, (uint16_t)pv);
-			tempControl.storeSettings(pv);
-			pv += sizeof(BeerBlock); // advance to next beer
-		}
+		// the cleared beer blocks hold no valid record, this becomes the first one
+		storeSettingsRecord(pv + offsetof(ChamberBlock, beer));
 	}
 
 	// set the version flag - so that storeDevice will work
 	eepromAccess.writeByte(0, EEPROM_FORMAT_VERSION);
 
+	// the defaults were written to all chambers, pending changes are outdated
+	dirtyConstants = 0;
+	dirtySettings = 0;
+
 	saveDefaultDevices();
 	// set state to startup
-	tempControl.init();
+	FOR_EACH_CHAMBER(init);
 }
 
 uint8_t EepromManager::saveDefaultDevices()
@@ -106,10 +113,19 @@ bool EepromManager::applySettings()
 
 	// logDebug("Applying settings");
 
-	// load the one chamber and one beer for now
-	eptr_t pv = pointerOffset(chambers);
-	tempControl.loadConstants(pv + offsetof(ChamberBlock, chamberSettings.cc));
-	tempControl.loadSettings(pv + offsetof(ChamberBlock, beer[0].cs));
+	// load each chamber with its first beer
+	for (chamber_id chamber = 0; chamber < ChamberManager::chamberCount(); chamber++)
+	{
+		ChamberScope scope(chamber);
+		eptr_t pv = pointerOffset(chambers) + sizeof(ChamberBlock) * chamber;
+		tempControl.loadConstants(pv + offsetof(ChamberBlock, chamberSettings.cc));
+		pv += offsetof(ChamberBlock, beer);
+		BeerBlock newest;
+		int8_t beer = findNewestSettings(pv, newest);
+		if (beer > 0)
+			pv += sizeof(BeerBlock) * beer;
+		tempControl.loadSettings(pv + offsetof(BeerBlock, cs));
+	}
 
 	// logDebug("Applied settings");
 
@@ -129,21 +145,90 @@ bool EepromManager::applySettings()
 
 void EepromManager::storeTempConstantsAndSettings()
 {
-	uint8_t chamber = 0;
-	eptr_t pv = pointerOffset(chambers);
-	pv += sizeof(ChamberBlock) * chamber;
-	tempControl.storeConstants(pv + offsetof(ChamberBlock, chamberSettings.cc));
-
+	dirtyConstants |= 1 << ChamberManager::currentChamber();
 	storeTempSettings();
 }
 
 void EepromManager::storeTempSettings()
 {
-	uint8_t chamber = 0;
-	eptr_t pv = pointerOffset(chambers);
-	pv += sizeof(ChamberBlock) * chamber;
-	// for now assume just one beer.
-	tempControl.storeSettings(pv + offsetof(ChamberBlock, beer[0].cs));
+	dirtySettings |= 1 << ChamberManager::currentChamber();
+	storeRequests++;
+	lastStoreRequest = ticks.seconds();
+}
+
+void EepromManager::commitTempSettings()
+{
+	for (chamber_id chamber = 0; (dirtyConstants | dirtySettings) != 0; chamber++)
+	{
+		uint8_t mask = 1 << chamber;
+		if (!((dirtyConstants | dirtySettings) & mask))
+			continue;
+
+		ChamberScope scope(chamber);
+		eptr_t pv = pointerOffset(chambers);
+		pv += sizeof(ChamberBlock) * chamber;
+		if (dirtyConstants & mask)
+			tempControl.storeConstants(pv + offsetof(ChamberBlock, chamberSettings.cc));
+		// for now assume just one beer.
+		if (dirtySettings & mask)
+			storeSettingsRecord(pv + offsetof(ChamberBlock, beer));
+		dirtyConstants &= ~mask;
+		dirtySettings &= ~mask;
+		storeCommits++;
+	}
+}
+
+void EepromManager::commitTempSettingsWhenQuiet()
+{
+	if ((dirtyConstants | dirtySettings) && ticks.timeSince(lastStoreRequest) >= EEPROM_COMMIT_DELAY)
+		commitTempSettings();
+}
+
+static uint8_t settingsCheck(const BeerBlock &block)
+{
+	return ~OneWire::crc8((const uint8_t *)&block, offsetof(BeerBlock, check));
+}
+
+/**
+ * Returns the index of the newest valid settings record in the beer blocks starting at beers, or -1 when there is none.
+ */
+int8_t EepromManager::findNewestSettings(eptr_t beers, BeerBlock &newest)
+{
+	int8_t found = -1;
+	BeerBlock block;
+	for (uint8_t b = 0; b < ChamberBlock::MAX_BEERS; b++, beers += sizeof(BeerBlock))
+	{
+		eepromAccess.readBlock(&block, beers, sizeof(BeerBlock));
+		if (block.check != settingsCheck(block))
+			continue;
+		if (found < 0 || int8_t(block.sequence - newest.sequence) > 0)
+		{
+			newest = block;
+			found = b;
+		}
+	}
+	return found;
+}
+
+/**
+ * Writes the settings of the current chamber to the beer block after the newest record.
+ * The check byte is written last, so an interrupted write leaves the previous record as the newest.
+ */
+void EepromManager::storeSettingsRecord(eptr_t beers)
+{
+	BeerBlock record;
+	int8_t newest = findNewestSettings(beers, record);
+	if (newest >= 0 && memcmp(&record.cs, &tempControl.cs, sizeof(ControlSettings)) == 0)
+		return; // unchanged
+
+	record.cs = tempControl.cs;
+	record.sequence = (newest >= 0) ? uint8_t(record.sequence + 1) : 0;
+	record.check = settingsCheck(record);
+
+	eptr_t pv = beers + sizeof(BeerBlock) * uint8_t((newest + 1) % ChamberBlock::MAX_BEERS);
+	tempControl.storeSettings(pv + offsetof(BeerBlock, cs));
+	eepromAccess.writeByte(pv + offsetof(BeerBlock, sequence), record.sequence);
+	eepromAccess.writeByte(pv + offsetof(BeerBlock, check), record.check);
 }
 
 bool EepromManager::fetchDevice(DeviceConfig &config, uint8_t deviceIndex)
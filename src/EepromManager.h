@@ -32,13 +32,14 @@ license and credits. */
 #include "Brewpi.h"
 #include "Platform.h"
 #include "EepromAccess.h"
+#include "TicksImpl.h"
 
 void fill(int8_t *p, uint8_t size);
 void clear(uint8_t *p, uint8_t size);
 
 class DeviceConfig;
+struct BeerBlock;
 
-// todo - the Eeprom manager should avoid too frequent saves to the eeprom since it supports 100,000 writes.
 class EepromManager
 {
   public:
@@ -69,6 +70,8 @@ class EepromManager
 
 	/**
 	 * Save the chamber constants and beer settings to eeprom for the currently active chamber.
+	 * The values are only marked as changed. They are written by commitTempSettings(), so a message
+	 * that changes many settings results in a single write.
 	 */
 	static void storeTempConstantsAndSettings();
 
@@ -77,10 +80,33 @@ class EepromManager
 	 */
 	static void storeTempSettings();
 
+	/**
+	 * Write the changed constants and settings of all chambers to eeprom.
+	 */
+	static void commitTempSettings();
+
+	/**
+	 * Commit the changed settings once nothing changed for EEPROM_COMMIT_DELAY seconds. Called periodically.
+	 */
+	static void commitTempSettingsWhenQuiet();
+
+	// Number of store requests, and the number of times eeprom was actually written.
+	static uint16_t storeRequests;
+	static uint16_t storeCommits;
+
 	static bool fetchDevice(DeviceConfig &config, uint8_t deviceIndex);
 	static bool storeDevice(const DeviceConfig &config, uint8_t deviceIndex);
 
 	static uint8_t saveDefaultDevices();
+
+  private:
+	static int8_t findNewestSettings(eptr_t beers, BeerBlock &newest);
+	static void storeSettingsRecord(eptr_t beers);
+
+	// Changed constants and settings, one bit per chamber
+	static uint8_t dirtyConstants;
+	static uint8_t dirtySettings;
+	static ticks_seconds_t lastStoreRequest;
 };
 
 class EepromStream
@@ -0,0 +1,130 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#ifndef ARDUINO
+
+#include "FilterBatch.h"
+#include <algorithm>
+
+CascadedFilterBatch::CascadedFilterBatch(size_t count, uint8_t bValue)
+	: count(count), buffer(count)
+{
+	setCoefficients(bValue);
+	for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+	{
+		for (uint8_t d = 0; d < 3; d++)
+		{
+			sections[s].x[d].resize(count);
+			sections[s].y[d].resize(count);
+		}
+		sections[s].newest = 0;
+	}
+}
+
+void CascadedFilterBatch::setCoefficients(uint8_t bValue)
+{
+	a = bValue * 2 + 4;
+	b = bValue;
+}
+
+void CascadedFilterBatch::init(const temperature *values)
+{
+	for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+	{
+		for (uint8_t d = 0; d < 3; d++)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				sections[s].x[d][i] = sections[s].y[d][i] = tempRegularToPrecise(values[i]);
+			}
+		}
+	}
+}
+
+void CascadedFilterBatch::add(const temperature *values, temperature *outputs)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		buffer[i] = tempRegularToPrecise(values[i]);
+	}
+	addDoublePrecision(buffer.data(), NULL);
+	if (outputs != NULL)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			outputs[i] = readOutput(i);
+		}
+	}
+}
+
+void CascadedFilterBatch::addDoublePrecision(const temperature_precise *values, temperature_precise *outputs)
+{
+	// the output of each section is the input of the next
+	const temperature_precise *in = values;
+	for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+	{
+		addSection(sections[s], a, b, count, in);
+		in = sections[s].y[sections[s].newest].data();
+	}
+	if (outputs != NULL)
+	{
+		std::copy(in, in + count, outputs);
+	}
+}
+
+/*
+ * Same computation as FixedFilter::addDoublePrecision, for count filters. The arrays must not overlap.
+ */
+static void filterSamples(size_t count, uint8_t a, uint8_t b, const temperature_precise *__restrict in,
+						  const temperature_precise *__restrict x1, const temperature_precise *__restrict x2,
+						  const temperature_precise *__restrict y1, const temperature_precise *__restrict y2,
+						  temperature_precise *__restrict x0, temperature_precise *__restrict y0)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		y0[i] = fixedFilterEquation(in[i], x1[i], x2[i], y1[i], y2[i], a, b);
+		x0[i] = in[i];
+	}
+}
+
+/*
+ * The oldest delay element is overwritten with the new input and output, and becomes the newest one.
+ */
+void CascadedFilterBatch::addSection(Section &section, uint8_t a, uint8_t b, size_t count, const temperature_precise *in)
+{
+	uint8_t n1 = section.newest;		   // becomes xv[1], yv[1]
+	uint8_t n2 = (section.newest + 2) % 3; // becomes xv[2], yv[2]
+	uint8_t n0 = (section.newest + 1) % 3; // oldest, becomes xv[0], yv[0]
+
+	filterSamples(count, a, b, in, section.x[n1].data(), section.x[n2].data(), section.y[n1].data(), section.y[n2].data(),
+				  section.x[n0].data(), section.y[n0].data());
+	section.newest = n0;
+}
+
+#endif
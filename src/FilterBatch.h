@@ -0,0 +1,92 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#ifndef ARDUINO
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+#include "FilterCascaded.h"
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Host-only replay of many independent cascaded filters with the same
+ * coefficients, for example to evaluate filter settings on recorded sensor
+ * logs. Every call adds one sample to every filter. The results are
+ * identical to CascadedFilter.
+ *
+ * The state is stored as one array per delay element (structure of arrays),
+ * and the delay line is rotated instead of copied, so the inner loops can be
+ * vectorized by the compiler (gcc -O3). Not built for the Arduino.
+ */
+class CascadedFilterBatch
+{
+  public:
+	CascadedFilterBatch(size_t count, uint8_t bValue = 2);
+
+	size_t size() const { return count; }
+
+	void setCoefficients(uint8_t bValue);
+
+	// Initializes filter i with values[i]
+	void init(const temperature *values);
+
+	// Adds values[i] to filter i and stores its new output in outputs[i]. outputs may be NULL.
+	void add(const temperature *values, temperature *outputs);
+	void addDoublePrecision(const temperature_precise *values, temperature_precise *outputs);
+
+	temperature readOutput(size_t i) const
+	{
+		return tempPreciseToRegular(readOutputDoublePrecision(i));
+	}
+	temperature_precise readOutputDoublePrecision(size_t i) const
+	{
+		return sections[NUM_SECTIONS - 1].y[sections[NUM_SECTIONS - 1].newest][i];
+	}
+
+  private:
+	struct Section
+	{
+		std::vector<temperature_precise> x[3];
+		std::vector<temperature_precise> y[3];
+		uint8_t newest; // index of the most recent input and output
+	};
+
+	static void addSection(Section &section, uint8_t a, uint8_t b, size_t count, const temperature_precise *in);
+
+	size_t count;
+	uint8_t a;
+	uint8_t b;
+	Section sections[NUM_SECTIONS];
+	std::vector<temperature_precise> buffer;
+};
+
+#endif
@@ -51,14 +51,48 @@ void CascadedFilter::setCoefficients(uint8_t bValue)
 
 temperature CascadedFilter::add(temperature val)
 {
-	temperature_precise valDoublePrecision = tempRegularToPrecise(val);
+	temperature_precise valDoublePrecision = Fixed7_9::fromRaw(val).widen<7, 25>().raw();
 	valDoublePrecision = addDoublePrecision(valDoublePrecision);
 	// return output, shifted back to single precision
-	return tempPreciseToRegular(valDoublePrecision);
+	return Fixed7_25::fromRaw(valDoublePrecision).truncate<7, 9>().raw();
 }
 
 temperature_precise CascadedFilter::addDoublePrecision(temperature_precise val)
 {
+#if FILTER_CONSTANT_SHIFTS
+	// all sections share the same coefficients, use the kernel compiled for them if there is one
+	switch (sections[0].b)
+	{
+#if FILTER_CONSTANT_SHIFTS & (1 << 0)
+	case 0:
+		return cascadedFilterKernel<0>(sections, val);
+#endif
+#if FILTER_CONSTANT_SHIFTS & (1 << 1)
+	case 1:
+		return cascadedFilterKernel<1>(sections, val);
+#endif
+#if FILTER_CONSTANT_SHIFTS & (1 << 2)
+	case 2:
+		return cascadedFilterKernel<2>(sections, val);
+#endif
+#if FILTER_CONSTANT_SHIFTS & (1 << 3)
+	case 3:
+		return cascadedFilterKernel<3>(sections, val);
+#endif
+#if FILTER_CONSTANT_SHIFTS & (1 << 4)
+	case 4:
+		return cascadedFilterKernel<4>(sections, val);
+#endif
+#if FILTER_CONSTANT_SHIFTS & (1 << 5)
+	case 5:
+		return cascadedFilterKernel<5>(sections, val);
+#endif
+#if FILTER_CONSTANT_SHIFTS & (1 << 6)
+	case 6:
+		return cascadedFilterKernel<6>(sections, val);
+#endif
+	}
+#endif
 	temperature_precise input = val;
 	// input is input for next section, which is the output of the previous section
 	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
@@ -35,9 +35,30 @@ license and credits. */
 
 // Use 3 filter sections. This gives excellent filtering, without adding too much delay.
 // For 3 sections the stop band attenuation is 3x the single section attenuation in dB.
-// The delay is also tripled.
+// The delay is a bit more than tripled. Step response with 3 sections, in samples:
+//
+//	b=0,	delay time = 9,		settling time (1%) = 18
+//	b=1,	delay time = 20,	settling time (1%) = 45
+//	b=2,	delay time = 43,	settling time (1%) = 97
+//	b=3,	delay time = 88,	settling time (1%) = 202
+//	b=4,	delay time = 179,	settling time (1%) = 412
+//	b=5,	delay time = 360,	settling time (1%) = 832
+//	b=6,	delay time = 723,	settling time (1%) = 1672
 #define NUM_SECTIONS 3
 
+/* Runs a value through the sections, which all use b == B, so all shift counts are constants.
+ * The sections are not unrolled: each kernel holds one copy of the filter equation.
+ */
+template <uint8_t B>
+temperature_precise cascadedFilterKernel(FixedFilter *sections, temperature_precise val)
+{
+	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
+	{
+		val = sections[i].addDoublePrecision<B>(val);
+	}
+	return val;
+}
+
 class CascadedFilter
 {
   public:
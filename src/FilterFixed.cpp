@@ -34,32 +34,18 @@ license and credits. */
 
 temperature FixedFilter::add(temperature val)
 {
-	temperature_precise returnVal = addDoublePrecision(tempRegularToPrecise(val));
-	return tempPreciseToRegular(returnVal);
+	temperature_precise returnVal = addDoublePrecision(Fixed7_9::fromRaw(val).widen<7, 25>().raw());
+	return Fixed7_25::fromRaw(returnVal).truncate<7, 9>().raw();
 }
 
 temperature_precise FixedFilter::addDoublePrecision(temperature_precise val)
 {
-	xv[2] = xv[1];
-	xv[1] = xv[0];
-	xv[0] = val;
-
-	yv[2] = yv[1];
-	yv[1] = yv[0];
-
-	/* Implementation that prevents overflow as much as possible by order of operations: */
-	yv[0] = ((yv[1] - yv[2]) + yv[1])						  // expected value + 1*
-			- (yv[1] >> b) + (yv[2] >> b) +					  // expected value +0*
-			+(xv[0] >> a) + (xv[1] >> (a - 1)) + (xv[2] >> a) // expected value +(1>>(a-2))
-			- (yv[2] >> (a - 2));							  // expected value -(1>>(a-2))
-
-	return yv[0];
+	return addWithShifts(val, a, b);
 }
 
 void FixedFilter::init(temperature val)
 {
-	xv[0] = val;
-	xv[0] = tempRegularToPrecise(xv[0]); // 16 extra bits are used in the filter for the fraction part
+	xv[0] = Fixed7_9::fromRaw(val).widen<7, 25>().raw(); // 16 extra bits are used in the filter for the fraction part
 
 	xv[1] = xv[0];
 	xv[2] = xv[0];
@@ -73,7 +59,7 @@ temperature FixedFilter::detectPosPeak(void)
 {
 	if (yv[0] < yv[1] && yv[1] >= yv[2])
 	{
-		return tempPreciseToRegular(yv[1]);
+		return Fixed7_25::fromRaw(yv[1]).truncate<7, 9>().raw();
 	}
 	else
 	{
@@ -85,7 +71,7 @@ temperature FixedFilter::detectNegPeak(void)
 {
 	if (yv[0] > yv[1] && yv[1] <= yv[2])
 	{
-		return tempPreciseToRegular(yv[1]);
+		return Fixed7_25::fromRaw(yv[1]).truncate<7, 9>().raw();
 	}
 	else
 	{
@@ -39,8 +39,13 @@ H(z) = 2^-a * -------------------------------------------------
 				1  + (-2 + 2^-b)z^-1  + (1-2^-b + 4* 2^-a)z^-2
 
  All filter coefficients are powers of two, so the filter can be efficiently implemented with bit shifts
- The DC gain is exactly 1.
- For real poles, and therefore no overshoot, use a <= 2b+4.
+ The DC gain is exactly 1. Because the shifts truncate, the output settles slightly above a constant input in
+ temperature_precise: up to 0.0004 degree at b=6, less than 0.0001 degree for b <= 5. That is less than the
+ resolution of temperature, so readOutput() returns the input once the filter has settled.
+ For real poles, and therefore no overshoot, use a <= 2b+4. Apart from the offset above there is no overshoot.
+ The intermediate results of the sum stay within temperature_precise for steps up to 102 degrees at b=0,
+ 120 degrees at b=1, 126 degrees at b=2 and 127 degrees for b >= 3.
+ test/test_native_filters checks these figures and the tables below.
  To calculate the poles, you can use this wolfram alpha link:
  http://www.wolframalpha.com/input/?i=solve+%281++%2B+%28-2+%2B+2^-b%29z^-1++%2B+%281-2^-b+%2B+4*+2^-a%29z^-2%29+%3D+0+where+a+%3D+24+and+b+%3D+10
  The filter has a zero at z = -1
@@ -65,18 +70,35 @@ H(z) = 2^-a * -------------------------------------------------
 
 	Here are the specifications for a single stage filter, for values a=2b+4
 	The delay time is the time it takes to rise to 0.5 in a step response.
-	When cascaded filters are used, multiply the delay time by the number of cascades.
-
-	a=4,	b=0,	delay time = 3
-	a=6,	b=1,	delay time = 6
-	a=8,	b=2,	delay time = 13
-	a=10,	b=3,	delay time = 26
-	a=12,	b=4,	delay time = 53
-	a=14,	b=5,	delay time = 106
-	a=16,	b=6,	delay time = 213
+	The settling time is the time it takes to stay within 1% of the step.
+	The ramp lag is how far the output lags behind a steady ramp.
+	When cascaded filters are used, the delay time is roughly multiplied by the number of cascades,
+	see FilterCascaded.h.
+
+	a=4,	b=0,	delay time = 3,		settling time = 9,		ramp lag = 3
+	a=6,	b=1,	delay time = 6,		settling time = 22,		ramp lag = 7
+	a=8,	b=2,	delay time = 13,	settling time = 49,		ramp lag = 15
+	a=10,	b=3,	delay time = 26,	settling time = 102,	ramp lag = 31
+	a=12,	b=4,	delay time = 53,	settling time = 208,	ramp lag = 63
+	a=14,	b=5,	delay time = 107,	settling time = 420,	ramp lag = 127
+	a=16,	b=6,	delay time = 214,	settling time = 845,	ramp lag = 255
 
 */
 
+/* One step of the filter equation. yv[0] is calculated from the new input x0, the previous inputs x1 and x2 and the
+ * previous outputs y1 and y2. Always inlined, so a caller that passes constant shift counts gets constant shifts:
+ * on AVR a variable shift of a 32-bit value is a loop with a counter, shifts by whole bytes are register moves.
+ */
+__attribute__((always_inline)) inline temperature_precise fixedFilterEquation(temperature_precise x0, temperature_precise x1, temperature_precise x2,
+																			   temperature_precise y1, temperature_precise y2, uint8_t a, uint8_t b)
+{
+	/* Implementation that prevents overflow as much as possible by order of operations: */
+	return ((y1 - y2) + y1)						   // expected value + 1*
+		   - (y1 >> b) + (y2 >> b) +			   // expected value +0*
+		   +(x0 >> a) + (x1 >> (a - 1)) + (x2 >> a) // expected value +(1>>(a-2))
+		   - (y2 >> (a - 2));					   // expected value -(1>>(a-2))
+}
+
 class FixedFilter
 {
   public:
@@ -100,14 +122,35 @@ class FixedFilter
 	temperature add(temperature val); // adds a value and returns the most recent filter output
 	temperature_precise addDoublePrecision(temperature_precise val);
 
+	// Same as addDoublePrecision, for b == B. The shift counts are constants.
+	template <uint8_t B>
+	temperature_precise addDoublePrecision(temperature_precise val)
+	{
+		return addWithShifts(val, B * 2 + 4, B);
+	}
+
+	__attribute__((always_inline)) temperature_precise addWithShifts(temperature_precise val, uint8_t aValue, uint8_t bValue)
+	{
+		xv[2] = xv[1];
+		xv[1] = xv[0];
+		xv[0] = val;
+
+		yv[2] = yv[1];
+		yv[1] = yv[0];
+
+		yv[0] = fixedFilterEquation(xv[0], xv[1], xv[2], yv[1], yv[2], aValue, bValue);
+
+		return yv[0];
+	}
+
 	temperature readOutput(void)
 	{
-		return yv[0] >> 16; // return 16 most significant bits of most recent output
+		return Fixed7_25::fromRaw(yv[0]).truncate<7, 9>().raw(); // return 16 most significant bits of most recent output
 	}
 
 	temperature readInput(void)
 	{
-		return xv[0] >> 16; // return 16 most significant bits of most recent input
+		return Fixed7_25::fromRaw(xv[0]).truncate<7, 9>().raw(); // return 16 most significant bits of most recent input
 	}
 
 	temperature_precise readOutputDoublePrecision(void)
@@ -0,0 +1,99 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "Platform.h"
+#include "FilterLeastSquares.h"
+
+#if TEMP_SENSOR_SLOPE_REGRESSION
+void LeastSquaresSlope::setWindow(uint16_t windowSize)
+{
+	window = max(windowSize, uint16_t(MIN_WINDOW));
+	interval = (window + MAX_POINTS - 1) / MAX_POINTS;
+	numPoints = window / interval;
+	init(0);
+}
+
+void LeastSquaresSlope::init(temperature val)
+{
+	for (uint8_t k = 0; k < numPoints; k++)
+	{
+		points[k] = val;
+	}
+	next = 0;
+	sampleCount = 0;
+	sampleSum = 0;
+	sum = int32_t(val) * numPoints;
+	weightedSum = int32_t(val) * (numPoints * (numPoints - 1) / 2);
+}
+
+void LeastSquaresSlope::add(temperature val)
+{
+	sampleSum += val;
+	if (++sampleCount == interval)
+	{
+		addPoint(sampleSum / interval);
+		sampleSum = 0;
+		sampleCount = 0;
+	}
+}
+
+void LeastSquaresSlope::addPoint(temperature val)
+{
+	temperature oldest = points[next];
+	points[next] = val;
+	if (++next == numPoints)
+	{
+		next = 0;
+	}
+	// all points move one position towards the oldest
+	weightedSum += int32_t(numPoints - 1) * val - (sum - oldest);
+	sum += int32_t(val) - oldest;
+}
+
+temperature LeastSquaresSlope::readSlope() const
+{
+	/* slope per point = sum((k - c) * y) / sum((k - c)^2), with c = (numPoints - 1) / 2.
+	 * Numerator and denominator are doubled to stay in integers.
+	 * The slope per hour is the slope per point * 3600 / interval.
+	 */
+	int32_t numerator = 2 * weightedSum - int32_t(numPoints - 1) * sum;
+	int32_t denominator = int32_t(numPoints) * (int32_t(numPoints) * numPoints - 1) / 6 * interval;
+
+	// multiply by 3600 without overflow
+	int32_t quotient = numerator / denominator;
+	int32_t remainder = numerator % denominator;
+	if (quotient > 9 || quotient < -9) // more than 9 * 3600 is out of range
+	{
+		return (quotient > 0) ? MAX_TEMP : MIN_TEMP;
+	}
+	int32_t slope = quotient * 3600 + remainder * 3600 / denominator;
+	return constrain(slope, MIN_TEMP, MAX_TEMP);
+}
+#endif
@@ -0,0 +1,79 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+#include <stddef.h>
+
+#if TEMP_SENSOR_SLOPE_REGRESSION
+/* Estimates the slope of a signal with a least squares fit of a line through the samples of the last
+ * 'window' seconds. To save RAM, at most MAX_POINTS points are kept: each point is the average of
+ * 'interval' consecutive samples. Only the sum and the weighted sum of the points are kept besides the
+ * points themselves, so adding a sample takes constant time and all arithmetic is exact integer arithmetic.
+ *
+ * For a steady ramp the estimate lags about window / 2 seconds behind.
+ *
+ * The class has no constructor or destructor, so it can be allocated with malloc(), which returns NULL when
+ * there is no memory left. Call setWindow() before use.
+ */
+class LeastSquaresSlope
+{
+  public:
+	static const uint8_t MIN_WINDOW = 8; // seconds
+	static const uint8_t MAX_POINTS = 32;
+
+	void setWindow(uint16_t window); // in seconds, up to MAX_POINTS * 255. Also initializes all points to 0.
+
+	uint16_t getWindow() const
+	{
+		return window;
+	}
+
+	void init(temperature val);
+	void add(temperature val); // add a sample, once per second
+
+	// Returns the slope per hour
+	temperature readSlope() const;
+
+  private:
+	void addPoint(temperature val);
+
+	temperature points[MAX_POINTS]; // ring buffer of numPoints points, points[next] is the oldest
+	uint16_t window;
+	uint8_t interval;	// samples per point
+	uint8_t numPoints;
+	uint8_t next;
+	uint8_t sampleCount;  // samples in sampleSum
+	int32_t sampleSum;	// sum of the samples of the next point
+	int32_t sum;		  // sum of points[k]
+	int32_t weightedSum; // sum of k * points[k], with k = 0 for the oldest point
+};
+#endif
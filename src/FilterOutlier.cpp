@@ -0,0 +1,78 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "FilterOutlier.h"
+
+#if TEMP_SENSOR_OUTLIER_WINDOW
+static const long_temperature outlierThreshold = Fixed7_9::fromDouble(TEMP_SENSOR_OUTLIER_THRESHOLD).raw();
+
+void OutlierFilter::init(temperature val)
+{
+	for (uint8_t i = 0; i < TEMP_SENSOR_OUTLIER_WINDOW; i++)
+	{
+		readings[i] = val;
+	}
+	oldest = 0;
+}
+
+temperature OutlierFilter::add(temperature val)
+{
+	readings[oldest] = val;
+	if (++oldest >= TEMP_SENSOR_OUTLIER_WINDOW)
+	{
+		oldest = 0;
+	}
+
+	// insertion sort of a copy, the window is only a few readings
+	temperature sorted[TEMP_SENSOR_OUTLIER_WINDOW];
+	for (uint8_t i = 0; i < TEMP_SENSOR_OUTLIER_WINDOW; i++)
+	{
+		temperature t = readings[i];
+		uint8_t j = i;
+		for (; j > 0 && sorted[j - 1] > t; j--)
+		{
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = t;
+	}
+	temperature median = sorted[TEMP_SENSOR_OUTLIER_WINDOW / 2];
+
+	long_temperature deviation = long_temperature(val) - median; // can exceed the range of temperature
+	if (deviation > outlierThreshold || deviation < -outlierThreshold)
+	{
+		if (rejected < UINT16_MAX)
+		{
+			rejected++;
+		}
+		return median;
+	}
+	return val;
+}
+#endif
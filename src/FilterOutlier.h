@@ -0,0 +1,69 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+
+#if TEMP_SENSOR_OUTLIER_WINDOW
+/* Rejects single bad readings before they reach the filters of a TempSensor.
+ *
+ * The last TEMP_SENSOR_OUTLIER_WINDOW raw readings, including the new one, are kept. When the new reading
+ * differs more than TEMP_SENSOR_OUTLIER_THRESHOLD from their median, it is counted as rejected and the median
+ * is returned instead, so the filters still get one sample per second. This is a Hampel filter with a fixed
+ * threshold: the quantization of a DS18B20 makes the median absolute deviation 0 most of the time.
+ *
+ * With a window of 3, one bad reading in a row is removed and a real step passes one sample late. A window
+ * of 5 removes two bad readings in a row and delays a step by two samples.
+ * Each filter takes 2 * TEMP_SENSOR_OUTLIER_WINDOW + 3 bytes of RAM, 9 with the default window.
+ */
+class OutlierFilter
+{
+  public:
+	OutlierFilter()
+	{
+		init(0);
+		rejected = 0;
+	}
+
+	void init(temperature val);
+	temperature add(temperature val);
+
+	uint16_t rejectedCount() const
+	{
+		return rejected;
+	}
+
+  private:
+	temperature readings[TEMP_SENSOR_OUTLIER_WINDOW];
+	uint8_t oldest;
+	uint16_t rejected;
+};
+#endif
@@ -0,0 +1,195 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Fixed point value types.
+ *
+ * Fixed<IntBits, FracBits> holds a signed value with IntBits integer bits (including the sign) and FracBits
+ * fraction bits, stored in an int16_t or int32_t. The raw value has the same layout as the plain typedefs in
+ * TemperatureFormats.h, so eeprom and serial formats are not affected: convert with fromRaw() and raw() at the
+ * boundary, and do the arithmetic in between with the types, so a format change needs an explicit widen() or
+ * saturate().
+ *
+ * All members are inline and compile to the same integer code as the macros and helper functions they replace,
+ * except clamp() of Fixed7_9: the range check that ends every product and saturation to the temperature format is
+ * one shared function, as constrainTemp16() was.
+ * + and - wrap like integers. The saturating operations clamp to [minRaw(), maxRaw()]; the two lowest raw
+ * values are not used by them, so they stay free for INVALID_TEMP and DISABLED_TEMP.
+ */
+
+template <uint8_t TotalBits, bool Fits16 = (TotalBits <= 16)>
+struct FixedRaw
+{
+	typedef int32_t type;
+};
+
+template <uint8_t TotalBits>
+struct FixedRaw<TotalBits, true>
+{
+	typedef int16_t type;
+};
+
+template <uint8_t IntBits, uint8_t FracBits>
+class Fixed
+{
+  public:
+	typedef typename FixedRaw<IntBits + FracBits>::type raw_t;
+
+	static_assert(IntBits + FracBits == 16 || IntBits + FracBits == 32, "Fixed needs 16 or 32 bits");
+
+	constexpr Fixed() : value(0) {}
+
+	static constexpr Fixed fromRaw(raw_t raw)
+	{
+		return Fixed(raw, true);
+	}
+
+	// Rounds half away from zero and saturates, like doubleToTempDiff. For compile time constants only.
+	static constexpr Fixed fromDouble(double d)
+	{
+		return (d * (int32_t(1) << FracBits) + 0.5 >= maxRaw()) ? fromRaw(maxRaw())
+			 : (d * (int32_t(1) << FracBits) - 0.5 <= minRaw()) ? fromRaw(minRaw())
+			 : (d < 0) ? fromRaw(raw_t(d * (int32_t(1) << FracBits) - 0.5))
+					   : fromRaw(raw_t(d * (int32_t(1) << FracBits) + 0.5));
+	}
+
+	static constexpr raw_t maxRaw()
+	{
+		return raw_t(~(uint32_t(1) << (IntBits + FracBits - 1)));
+	}
+
+	static constexpr raw_t minRaw()
+	{
+		return raw_t(-maxRaw() + 1);
+	}
+
+	constexpr raw_t raw() const
+	{
+		return value;
+	}
+
+	// Converts to a type with at least as many integer and fraction bits. The value is not changed.
+	template <uint8_t I, uint8_t F>
+	constexpr Fixed<I, F> widen() const
+	{
+		static_assert(I >= IntBits && F >= FracBits, "widen() cannot drop bits, use saturate()");
+		return Fixed<I, F>::fromRaw(typename Fixed<I, F>::raw_t(value) * (int32_t(1) << (F - FracBits)));
+	}
+
+	// Drops fraction bits, for a type with at least as many integer bits. No value can be out of range, so
+	// this is a plain shift (rounding towards minus infinity).
+	template <uint8_t I, uint8_t F>
+	constexpr Fixed<I, F> truncate() const
+	{
+		static_assert(I >= IntBits && F <= FracBits, "truncate() cannot drop integer bits, use saturate()");
+		return Fixed<I, F>::fromRaw(typename Fixed<I, F>::raw_t(value >> (FracBits - F)));
+	}
+
+	// Converts to a type with at most as many fraction bits. Extra fraction bits are truncated (rounded
+	// towards minus infinity) and values out of range are clamped.
+	template <uint8_t I, uint8_t F>
+	Fixed<I, F> saturate() const
+	{
+		static_assert(F <= FracBits, "saturate() cannot add fraction bits, use widen()");
+		return Fixed<I, F>::clamp(value >> (FracBits - F));
+	}
+
+	// Clamps to [minRaw(), maxRaw()] where + would wrap around
+	Fixed saturatingAdd(Fixed other) const
+	{
+		raw_t sum;
+		if (__builtin_add_overflow(value, other.value, &sum))
+		{
+			return fromRaw(other.value < 0 ? minRaw() : maxRaw());
+		}
+		return fromRaw(sum < minRaw() ? minRaw() : sum);
+	}
+
+	// Multiplies by a value of any format, the result has the format of this value. The product is
+	// calculated in 32 bits, as multiplyFactorTemperatureDiff() did, so it must fit in an int32_t.
+	template <uint8_t I, uint8_t F>
+	Fixed saturatingMul(Fixed<I, F> other) const
+	{
+		return multiply(*this, other);
+	}
+
+	template <uint8_t I, uint8_t F>
+	static Fixed multiply(Fixed a, Fixed<I, F> b)
+	{
+		return clamp((int32_t(a.value) * b.raw()) >> F);
+	}
+
+	static Fixed clamp(int32_t raw)
+	{
+		return fromRaw(raw_t(raw < minRaw() ? minRaw() : raw > maxRaw() ? maxRaw() : raw));
+	}
+
+	constexpr Fixed operator+(Fixed other) const
+	{
+		return fromRaw(raw_t(value + other.value));
+	}
+
+	constexpr Fixed operator-(Fixed other) const
+	{
+		return fromRaw(raw_t(value - other.value));
+	}
+
+	constexpr Fixed operator-() const
+	{
+		return fromRaw(raw_t(-value));
+	}
+
+	constexpr Fixed operator>>(uint8_t shift) const
+	{
+		return fromRaw(raw_t(value >> shift));
+	}
+
+	constexpr bool operator<(Fixed other) const { return value < other.value; }
+	constexpr bool operator>(Fixed other) const { return value > other.value; }
+	constexpr bool operator<=(Fixed other) const { return value <= other.value; }
+	constexpr bool operator>=(Fixed other) const { return value >= other.value; }
+	constexpr bool operator==(Fixed other) const { return value == other.value; }
+	constexpr bool operator!=(Fixed other) const { return value != other.value; }
+
+  private:
+	constexpr Fixed(raw_t raw, bool) : value(raw) {}
+
+	raw_t value;
+};
+
+typedef Fixed<7, 9> Fixed7_9;	// temperature
+typedef Fixed<23, 9> Fixed23_9; // long_temperature
+typedef Fixed<7, 25> Fixed7_25; // temperature_precise
+
+// Defined in TemperatureFormats.cpp
+template <>
+Fixed7_9 Fixed7_9::clamp(int32_t raw);
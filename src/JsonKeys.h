@@ -35,6 +35,8 @@ license and credits. */
 #include <avr/pgmspace.h>
 #endif
 
+static const char JSONKEY_chamber[] PROGMEM = "chamber";
+static const char JSONKEY_chamberCount[] PROGMEM = "count";
 static const char JSONKEY_mode[] PROGMEM = "mode";
 static const char JSONKEY_beerSetting[] PROGMEM = "beerSet";
 static const char JSONKEY_fridgeSetting[] PROGMEM = "fridgeSet";
@@ -81,5 +83,55 @@ static const char JSONKEY_posPeakEstimate[] PROGMEM = "posPeakEst";
 static const char JSONKEY_negPeak[] PROGMEM = "negPeak"; // last true neg peak
 static const char JSONKEY_posPeak[] PROGMEM = "posPeak";
 
+// telemetry format
+static const char JSONKEY_compact[] PROGMEM = "compact";
+static const char JSONKEY_binary[] PROGMEM = "binary";
+
+// telemetry subscription
+static const char JSONKEY_groups[] PROGMEM = "groups";
+static const char JSONKEY_period[] PROGMEM = "period";
+static const char JSONKEY_deadband[] PROGMEM = "deadband";
+static const char JSONKEY_humidityDeadband[] PROGMEM = "humDeadband";
+
+// full state snapshot
+static const char JSONKEY_settings[] PROGMEM = "settings";
+static const char JSONKEY_constants[] PROGMEM = "constants";
+static const char JSONKEY_variables[] PROGMEM = "variables";
+static const char JSONKEY_temps[] PROGMEM = "temps";
+static const char JSONKEY_waitTime[] PROGMEM = "wait";
+static const char JSONKEY_lcd[] PROGMEM = "lcd";
+
+// eeprom write statistics
+static const char JSONKEY_storeRequests[] PROGMEM = "storeReq";
+static const char JSONKEY_storeCommits[] PROGMEM = "storeCommit";
+
+// output queue statistics
+static const char JSONKEY_txQueued[] PROGMEM = "txQueued";
+static const char JSONKEY_txDropped[] PROGMEM = "txDropped";
+static const char JSONKEY_txPeak[] PROGMEM = "txPeak";
+
+// rejected sensor readings
+static const char JSONKEY_beerRejected[] PROGMEM = "beerRejected";
+static const char JSONKEY_fridgeRejected[] PROGMEM = "fridgeRejected";
+
+// temperature history
+static const char JSONKEY_historyFrom[] PROGMEM = "from";
+static const char JSONKEY_historyCount[] PROGMEM = "count";
+static const char JSONKEY_historyInterval[] PROGMEM = "interval";
+static const char JSONKEY_historyAge[] PROGMEM = "age";
+static const char JSONKEY_historyNext[] PROGMEM = "next";
+static const char JSONKEY_historySamples[] PROGMEM = "samples";
+
+// loop profiler stages
+static const char JSONKEY_profileTemperatures[] PROGMEM = "temps";
+static const char JSONKEY_profilePeaks[] PROGMEM = "peaks";
+static const char JSONKEY_profilePID[] PROGMEM = "pid";
+static const char JSONKEY_profileState[] PROGMEM = "state";
+static const char JSONKEY_profileOutputs[] PROGMEM = "outputs";
+static const char JSONKEY_profileUI[] PROGMEM = "ui";
+static const char JSONKEY_profileReceive[] PROGMEM = "receive";
+static const char JSONKEY_profileTasks[] PROGMEM = "tasks";
+
 static const char JSONKEY_logType[] PROGMEM = "logType";
 static const char JSONKEY_logID[] PROGMEM = "logID";
+static const char JSONKEY_logAge[] PROGMEM = "logAge";
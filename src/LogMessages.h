@@ -46,7 +46,7 @@ Bump this version number when changing this file and copy the new version to
 the brewpi-script repository.
 */
 
-#define BREWPI_LOG_MESSAGES_VERSION 3
+#define BREWPI_LOG_MESSAGES_VERSION 8
 
 #define MSG(errorID, errorString, ...) errorID
 
@@ -71,7 +71,8 @@ enum errorMessages
         MSG(ERROR_EXPECTED_BRACKET, "Expected { got %c.", character),
         MSG(ERROR_ONEWIRE_INIT_FAILED, "OneWire initialization failed."),
         MSG(ERROR_DEVICE_ALREADY_INSTALLED, "This hardware device is already installed at slot %d. Uninstall it first.", slot),
-        MSG(ERROR_FUNCTION_ALREADY_INSTALLED, "This device function is already installed at slot %d. Uninstall it first.", slot)
+        MSG(ERROR_FUNCTION_ALREADY_INSTALLED, "This device function is already installed at slot %d. Uninstall it first.", slot),
+        MSG(ERROR_JSON_KEYS_NOT_SORTED, "JSON key table is not sorted at index %d, some keys will not be found.", index)
 
 };
 
@@ -91,7 +92,14 @@ enum warningMessages
         MSG(FALLING_BACK_ON_BACKUP_SENSOR, "Falling back on backup sensor."),
 
         // DS2413.cpp
-        MSG(DS2413_DISCONNECTED, "OneWire actuator (DS2413) disconnected, address %s.", addressString)
+        MSG(DS2413_DISCONNECTED, "OneWire actuator (DS2413) disconnected, address %s.", addressString),
+
+        // PiLink.cpp
+        MSG(WARNING_JSON_TOKEN_TRUNCATED, "Setting ignored, key or value longer than %d characters: %s.", maxLength, key),
+        MSG(WARNING_JSON_TIMEOUT, "Timeout receiving JSON, processed the partial data."),
+
+        // Logger.cpp
+        MSG(WARNING_LOG_QUEUE_FULL, "Log queue full, %d messages dropped.", count)
 
 };
 
@@ -133,5 +141,12 @@ enum infoMessages
         MSG(BACK_ON_MAIN_SENSOR, "Back on main sensor instead of backup sensor."),
 
         // DS2413.cpp
-        MSG(DS2413_CONNECTED, "OneWire actuator (DS2413) connected, address %s.", addressString)
+        MSG(DS2413_CONNECTED, "OneWire actuator (DS2413) connected, address %s.", addressString),
+
+        // Tempcontrol.cpp
+        MSG(INFO_PEAK_DETECTOR_STATS, "Fridge peak detector: %d peaks accepted, %d rejected as noise.", accepted, rejected),
+
+        // Logger.cpp
+        MSG(INFO_LOG_MESSAGES_SUPPRESSED, "%d more messages of type %s with ID %d suppressed.", count, type, id),
+        MSG(INFO_LOG_RATE_SLOTS_FULL, "%d messages suppressed while all rate limit slots were in use.", count)
 };
@@ -34,44 +34,328 @@ license and credits. */
 #include "Logger.h"
 #include "PiLink.h"
 #include "JsonKeys.h"
+#include "Ticks.h"
 
-static const char PROGMEM LOG_STRING_FORMAT[] = "\"%s\"";
+#if defined(WIRING) && defined(SERIAL_TX_BUFFER_SIZE)
+// nothing is waiting in the transmit buffer of the serial port
+#define SERIAL_IDLE() (Serial.availableForWrite() >= SERIAL_TX_BUFFER_SIZE - 1)
+#else
+#define SERIAL_IDLE() 1
+#endif
+
+#if PILINK_TX_QUEUE_SIZE
+#define OUTPUT_IDLE() (PiLinkTxQueue::isEmpty() && SERIAL_IDLE())
+#else
+#define OUTPUT_IDLE() SERIAL_IDLE()
+#endif
+
+#if LOG_RATE_LIMIT
+// Messages of one type and ID logged in the current period. A slot is free when count is 0.
+struct LogRateSlot
+{
+	char type;
+	LOG_ID_TYPE id;
+	uint8_t count;		  // messages sent
+	uint16_t suppressed;  // messages not sent
+	ticks_seconds_t start; // start of the period
+};
+
+static LogRateSlot rateSlots[LOG_RATE_SLOTS];
+
+// Messages suppressed because all slots were used by other IDs, reported after LOG_RATE_PERIOD seconds
+static uint16_t overflowSuppressed;
+static ticks_seconds_t overflowStart;
+#endif
+
+#if LOG_QUEUE_SIZE
+// A record is the length of the encoded message, the time it was logged (2 bytes, in seconds) and the message.
+#define LOG_RECORD_HEADER 3
+
+static uint8_t records[LOG_QUEUE_SIZE][LOG_RECORD_SIZE];
+static uint8_t firstRecord;
+static uint8_t recordCount;
+static uint16_t droppedRecords;
+#endif
+
+#if LOG_RATE_LIMIT || LOG_QUEUE_SIZE
+// The INFO_RECEIVED_SETTING of each key of a settings upload answers the host. These are sent right away,
+// without rate limit or queue, so an upload is echoed in full.
+static bool isReply(char type, LOG_ID_TYPE errorID)
+{
+	return type == 'I' && errorID == INFO_RECEIVED_SETTING;
+}
+#endif
 
 void Logger::logMessageVaArg(char type, LOG_ID_TYPE errorID, const char *varTypes, ...)
 {
+#if LOG_RATE_LIMIT
+	if (!isReply(type, errorID) && !allowMessage(type, errorID))
+	{
+		return;
+	}
+#endif
 	va_list args;
+	va_start(args, varTypes);
+	logMessage(type, errorID, varTypes, args);
+	va_end(args);
+}
+
+// Logs messages about the logger itself, these are not rate limited
+void Logger::logUnlimited(char type, LOG_ID_TYPE errorID, const char *varTypes, ...)
+{
+	va_list args;
+	va_start(args, varTypes);
+	logMessage(type, errorID, varTypes, args);
+	va_end(args);
+}
+
+void Logger::logMessage(char type, LOG_ID_TYPE errorID, const char *varTypes, va_list args)
+{
+#if LOG_QUEUE_SIZE
+	if (!isReply(type, errorID))
+	{
+		if (recordCount == LOG_QUEUE_SIZE)
+		{
+			if (droppedRecords < UINT16_MAX)
+			{
+				droppedRecords++;
+			}
+			return;
+		}
+		uint8_t *record = records[(firstRecord + recordCount) % LOG_QUEUE_SIZE];
+		record[0] = encodeRecord(record + LOG_RECORD_HEADER, LOG_RECORD_SIZE - LOG_RECORD_HEADER, type, errorID, varTypes, args);
+		ticks_seconds_t now = ticks.seconds();
+		memcpy(record + 1, &now, sizeof(now));
+		recordCount++;
+		return;
+	}
+#endif
+#if BREWPI_BINARY_PILINK
+	if (piLink.binaryMode)
+	{
+		piLink.sendLogFrame(type, errorID, varTypes, args);
+		return;
+	}
+#endif
 	piLink.printResponse('D');
 	piLink.sendJsonPair(JSONKEY_logType, type);
 	piLink.sendJsonPair(JSONKEY_logID, errorID);
 	piLink.print_P(PSTR(",\"V\":["));
-	va_start(args, varTypes);
 	uint8_t index = 0;
-	char buf[9];
 	while (varTypes[index])
 	{
-		switch (varTypes[index])
+		if (varTypes[index] == 's')
 		{
-		case 'd': // integer, signed or unsigned
-			piLink.print_P(STR_FMT_D, va_arg(args, int));
-			break;
-		case 's': // string
-			piLink.print_P(LOG_STRING_FORMAT, va_arg(args, char *));
-			break;
-		case 't': // temperature in fixed_7_9 format
-			piLink.print_P(LOG_STRING_FORMAT, tempToString(buf, va_arg(args, int), 1, 12));
-			break;
-		case 'f': // fixed point value
-			piLink.print_P(LOG_STRING_FORMAT, fixedPointToString(buf, (temperature)va_arg(args, int), 3, 12));
-			break;
+			printArgument('s', 0, va_arg(args, char *));
+		}
+		else
+		{
+			printArgument(varTypes[index], va_arg(args, int), NULL);
 		}
 		if (varTypes[++index])
 		{
 			piLink.print(',');
 		}
 	}
-	va_end(args);
 	piLink.print(']');
 	piLink.sendJsonClose();
 }
 
+void Logger::printArgument(char varType, int value, const char *string)
+{
+	char buf[9];
+	switch (varType)
+	{
+	case 'd': // integer, signed or unsigned
+		piLink.print_P(STR_FMT_D, value);
+		break;
+	case 's': // string
+		piLink.printQuoted(string);
+		break;
+	case 't': // temperature in fixed_7_9 format
+		piLink.printQuoted(tempToString(buf, value, 1, sizeof(buf)));
+		break;
+	case 'f': // fixed point value
+		piLink.printQuoted(fixedPointToString(buf, (temperature)value, 3, sizeof(buf)));
+		break;
+	}
+}
+
+uint8_t Logger::encodeRecord(uint8_t *buffer, uint8_t size, char type, LOG_ID_TYPE errorID, const char *varTypes, va_list args)
+{
+	uint8_t *p = buffer;
+	uint8_t *end = p + size;
+	*p++ = type;
+	*p++ = errorID;
+	for (; *varTypes && p + 3 <= end; varTypes++)
+	{
+		*p++ = *varTypes;
+		if (*varTypes == 's')
+		{
+			const char *str = va_arg(args, char *);
+			uint8_t length = strnlen(str, end - p - 1);
+			memcpy(p, str, length);
+			p += length;
+			*p++ = 0;
+		}
+		else
+		{
+			int16_t value = va_arg(args, int);
+			memcpy(p, &value, sizeof(value));
+			p += sizeof(value);
+		}
+	}
+	return p - buffer;
+}
+
+#if LOG_QUEUE_SIZE
+// Sends a record like logMessage() would have sent the message, with its age in seconds.
+// Binary frames are the same as without the queue, without the age.
+void Logger::printRecord(const uint8_t *record, uint8_t length, uint16_t age)
+{
+#if BREWPI_BINARY_PILINK
+	if (piLink.binaryMode)
+	{
+		piLink.sendFrame('D', record, length);
+		return;
+	}
+#endif
+	const uint8_t *end = record + length;
+	piLink.printResponse('D');
+	piLink.sendJsonPair(JSONKEY_logType, (char)record[0]);
+	piLink.sendJsonPair(JSONKEY_logID, record[1]);
+	piLink.sendJsonPair(JSONKEY_logAge, age);
+	piLink.print_P(PSTR(",\"V\":["));
+	const uint8_t *p = record + 2;
+	while (p < end)
+	{
+		char varType = *p++;
+		if (varType == 's')
+		{
+			printArgument('s', 0, (const char *)p);
+			p += strlen((const char *)p) + 1;
+		}
+		else
+		{
+			int16_t value;
+			memcpy(&value, p, sizeof(value));
+			p += sizeof(value);
+			printArgument(varType, value, NULL);
+		}
+		if (p < end)
+		{
+			piLink.print(',');
+		}
+	}
+	piLink.print(']');
+	piLink.sendJsonClose();
+}
+#endif
+
+#if LOG_RATE_LIMIT
+bool Logger::allowMessage(char type, LOG_ID_TYPE errorID)
+{
+	ticks_seconds_t now = ticks.seconds();
+	uint8_t slot = LOG_RATE_SLOTS;
+	for (uint8_t i = 0; i < LOG_RATE_SLOTS; i++)
+	{
+		LogRateSlot &s = rateSlots[i];
+		if (s.count && ticks_seconds_t(now - s.start) >= LOG_RATE_PERIOD)
+		{
+			endRatePeriod(i);
+		}
+		if (!s.count)
+		{
+			slot = i; // free, used unless the ID has a slot
+		}
+		else if (s.type == type && s.id == errorID)
+		{
+			slot = i;
+			break;
+		}
+	}
+	if (slot == LOG_RATE_SLOTS)
+	{
+		// All slots are used by other IDs. Freeing one would restart its count, so with more IDs than slots
+		// in rotation nothing would be limited. Count the message as suppressed instead.
+		if (!overflowSuppressed)
+		{
+			overflowStart = now;
+		}
+		if (overflowSuppressed < UINT16_MAX)
+		{
+			overflowSuppressed++;
+		}
+		return false;
+	}
+	LogRateSlot &s = rateSlots[slot];
+	if (!s.count)
+	{
+		s.type = type;
+		s.id = errorID;
+		s.start = now;
+	}
+	if (s.count < LOG_RATE_LIMIT)
+	{
+		s.count++;
+		return true;
+	}
+	if (s.suppressed < UINT16_MAX)
+	{
+		s.suppressed++;
+	}
+	return false;
+}
+
+// Frees the slot, after logging the number of messages that were suppressed in its period
+void Logger::endRatePeriod(uint8_t slot)
+{
+	LogRateSlot &s = rateSlots[slot];
+	if (s.suppressed)
+	{
+		char type[2] = {s.type, 0};
+		logUnlimited('I', INFO_LOG_MESSAGES_SUPPRESSED, "dsd", s.suppressed, type, s.id);
+	}
+	s.count = 0;
+	s.suppressed = 0;
+}
+#endif
+
+void Logger::update(void)
+{
+#if LOG_RATE_LIMIT
+	for (uint8_t i = 0; i < LOG_RATE_SLOTS; i++)
+	{
+		if (rateSlots[i].count && ticks_seconds_t(ticks.seconds() - rateSlots[i].start) >= LOG_RATE_PERIOD)
+		{
+			endRatePeriod(i);
+		}
+	}
+	if (overflowSuppressed && ticks_seconds_t(ticks.seconds() - overflowStart) >= LOG_RATE_PERIOD)
+	{
+		uint16_t suppressed = overflowSuppressed;
+		overflowSuppressed = 0;
+		logUnlimited('I', INFO_LOG_RATE_SLOTS_FULL, "d", suppressed);
+	}
+#endif
+#if LOG_QUEUE_SIZE
+	// One message per call, when nothing else is being sent. Log messages never delay other output.
+	if (recordCount && OUTPUT_IDLE())
+	{
+		const uint8_t *record = records[firstRecord];
+		ticks_seconds_t logged;
+		memcpy(&logged, record + 1, sizeof(logged));
+		printRecord(record + LOG_RECORD_HEADER, record[0], ticks_seconds_t(ticks.seconds() - logged));
+		firstRecord = (firstRecord + 1) % LOG_QUEUE_SIZE;
+		recordCount--;
+		if (droppedRecords)
+		{
+			uint16_t dropped = droppedRecords;
+			droppedRecords = 0;
+			logUnlimited('W', WARNING_LOG_QUEUE_FULL, "d", dropped);
+		}
+	}
+#endif
+}
+
 Logger logger;
\ No newline at end of file
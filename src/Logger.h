@@ -43,6 +43,26 @@ class Logger
 	~Logger(){};
 
 	static void logMessageVaArg(const char type, LOG_ID_TYPE errorID, const char *varTypes, ...);
+
+	// Ends the rate limit periods that expired and sends a queued message when the serial port is idle.
+	// Called from PiLink::receive().
+	static void update(void);
+
+	// Stores type, ID and arguments as in a binary log frame: per argument its type, followed by a
+	// little-endian int16 or a zero terminated string. Returns the number of bytes used.
+	static uint8_t encodeRecord(uint8_t *buffer, uint8_t size, char type, LOG_ID_TYPE errorID, const char *varTypes, va_list args);
+
+  private:
+	static void logMessage(char type, LOG_ID_TYPE errorID, const char *varTypes, va_list args);
+	static void logUnlimited(char type, LOG_ID_TYPE errorID, const char *varTypes, ...);
+	static void printArgument(char varType, int value, const char *string);
+#if LOG_QUEUE_SIZE
+	static void printRecord(const uint8_t *record, uint8_t length, uint16_t age);
+#endif
+#if LOG_RATE_LIMIT
+	static bool allowMessage(char type, LOG_ID_TYPE errorID);
+	static void endRatePeriod(uint8_t slot);
+#endif
 };
 extern Logger logger;
 
@@ -148,6 +168,10 @@ inline void logInfoTemp(uint8_t debugId, temperature temp)
 {
 	logger.logMessageVaArg('I', debugId, "t", temp);
 }
+inline void logInfoIntInt(uint8_t debugId, int val1, int val2)
+{
+	logger.logMessageVaArg('I', debugId, "dd", val1, val2);
+}
 inline void logInfoIntString(uint8_t debugId, int val1, const char *val2)
 {
 	logger.logMessageVaArg('I', debugId, "ds", val1, val2);
@@ -177,6 +201,9 @@ inline void logInfoTempTempFixedFixed(uint8_t debugId, temperature t1, temperatu
 #define logInfoTemp(debugId, temp) \
 	{                              \
 	}
+#define logInfoIntInt(debugId, val1, val2) \
+	{                                      \
+	}
 #define logInfoStringString(debugId, val1, val2) \
 	{                                            \
 	}
@@ -0,0 +1,98 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "Ticks.h"
+
+/*
+ * Measures the execution time of the stages of the control loop. For each
+ * stage the call count, minimum, maximum and total time in microseconds are
+ * kept. The statistics are sent to the script with the 'p' command, which
+ * also resets them.
+ *
+ * Enable with BREWPI_LOOP_PROFILER. When disabled, PROFILE_STAGE just
+ * executes the statement.
+ */
+
+enum ProfilerStage
+{
+	PROFILE_UPDATE_TEMPERATURES,
+	PROFILE_DETECT_PEAKS,
+	PROFILE_UPDATE_PID,
+	PROFILE_UPDATE_STATE,
+	PROFILE_UPDATE_OUTPUTS,
+	PROFILE_UI_UPDATE,
+	PROFILE_PILINK_RECEIVE,
+	NUM_PROFILER_STAGES
+};
+
+#if BREWPI_LOOP_PROFILER
+
+struct ProfilerStats
+{
+	uint32_t count;
+	ticks_micros_t min;
+	ticks_micros_t max;
+	ticks_micros_t total; // saturates instead of wrapping
+};
+
+class LoopProfiler
+{
+  public:
+	static void add(uint8_t stage, ticks_micros_t duration);
+	static void reset();
+
+	static const ProfilerStats &getStats(uint8_t stage)
+	{
+		return stats[stage];
+	}
+
+  private:
+	static ProfilerStats stats[NUM_PROFILER_STAGES];
+};
+
+#define PROFILE_STAGE(stage, statement)                         \
+	do                                                          \
+	{                                                           \
+		ticks_micros_t profileStart = ticks.micros();           \
+		statement;                                              \
+		LoopProfiler::add(stage, ticks.micros() - profileStart); \
+	} while (0)
+
+#else
+
+#define PROFILE_STAGE(stage, statement) \
+	do                                  \
+	{                                   \
+		statement;                      \
+	} while (0)
+
+#endif
@@ -36,6 +36,56 @@ license and credits. */
 #include "PiLink.h"
 #include "Ticks.h"
 
+OneWireConversionManager::Bus OneWireConversionManager::buses[ONEWIRE_CONVERSION_MAX_BUSES];
+
+OneWireConversionManager::Bus *OneWireConversionManager::findBus(OneWire *bus)
+{
+    for (uint8_t i = 0; i < ONEWIRE_CONVERSION_MAX_BUSES; i++)
+    {
+        if (buses[i].wire == bus)
+            return &buses[i];
+    }
+    return NULL;
+}
+
+void OneWireConversionManager::addBus(OneWire *bus)
+{
+    if (bus == NULL || findBus(bus))
+        return;
+    Bus *b = findBus(NULL);
+    if (b)
+    {
+        b->wire = bus;
+        // no conversion in progress
+        b->requestTime = ticks.millis() - DallasTemperature::millisToWaitForConversion(12);
+    }
+}
+
+void OneWireConversionManager::requestConversions()
+{
+    for (uint8_t i = 0; i < ONEWIRE_CONVERSION_MAX_BUSES; i++)
+    {
+        Bus &b = buses[i];
+        if (b.wire && isConversionComplete(b.wire))
+        {
+            DallasTemperature(b.wire).requestTemperatures();
+            b.requestTime = ticks.millis();
+        }
+    }
+}
+
+bool OneWireConversionManager::isConversionComplete(OneWire *bus)
+{
+    Bus *b = findBus(bus);
+    return b == NULL || ticks.millis() - b->requestTime >= ticks_millis_t(DallasTemperature::millisToWaitForConversion(12));
+}
+
+bool OneWireConversionManager::isConversionCompleteSince(OneWire *bus, ticks_millis_t time)
+{
+    Bus *b = findBus(bus);
+    return b == NULL || (int32_t(b->requestTime - time) >= 0 && isConversionComplete(bus));
+}
+
 OneWireTempSensor::~OneWireTempSensor()
 {
     delete sensor;
@@ -45,7 +95,9 @@ OneWireTempSensor::~OneWireTempSensor()
  * Initializes the temperature sensor.
  * This method is called when the sensor is first created and also any time the sensor reports it's disconnected.
  * If the result is TEMP_SENSOR_DISCONNECTED then subsequent calls to read() will also return TEMP_SENSOR_DISCONNECTED.
- * Clients should attempt to re-initialize the sensor by calling init() again. 
+ * Clients should attempt to re-initialize the sensor by calling init() again.
+ * A sensor that was just powered on reports disconnected until the next bus conversion has completed, so
+ * this never blocks waiting for a conversion.
  */
 bool OneWireTempSensor::init()
 {
@@ -72,36 +124,40 @@ bool OneWireTempSensor::init()
     // This quickly tests if the sensor is connected and initializes the reset detection if necessary.
     if (sensor)
     {
+        OneWireConversionManager::addBus(oneWire);
+
         // If this is the first conversion after power on, the device will return DEVICE_DISCONNECTED
         // Because HIGH_ALARM_TEMP will be copied from EEPROM
         temperature temp = sensor->getTempRaw(sensorAddress);
         if (temp == DEVICE_DISCONNECTED)
         {
-            // Device was just powered on and should be initialized
+            // Device was just powered on and should be initialized. The next bus conversion
+            // replaces the power on value in the scratchpad.
             if (sensor->initConnection(sensorAddress))
             {
-                requestConversion();
-                waitForConversion();
-                temp = sensor->getTempRaw(sensorAddress);
+                awaitingConversion = true;
+                initTime = ticks.millis();
             }
         }
-        DEBUG_ONLY(logInfoIntStringTemp(INFO_TEMP_SENSOR_INITIALIZED, pinNr, addressString, temp));
-        success = temp != DEVICE_DISCONNECTED;
-        if (success)
+        else if (awaitingConversion)
         {
-            requestConversion(); // piggyback request for a new conversion
+            if (OneWireConversionManager::isConversionCompleteSince(oneWire, initTime))
+            {
+                awaitingConversion = false;
+            }
+            else
+            {
+                temp = DEVICE_DISCONNECTED;
+            }
         }
+        DEBUG_ONLY(logInfoIntStringTemp(INFO_TEMP_SENSOR_INITIALIZED, pinNr, addressString, temp));
+        success = temp != DEVICE_DISCONNECTED;
     }
     setConnected(success);
     // logDebug("init onewire sensor complete %d", success);
     return success;
 }
 
-void OneWireTempSensor::requestConversion()
-{
-    sensor->requestTemperaturesByAddress(sensorAddress);
-}
-
 void OneWireTempSensor::setConnected(bool connected)
 {
     if (this->connected == connected)
@@ -126,9 +182,14 @@ temperature OneWireTempSensor::read()
     if (!connected)
         return TEMP_SENSOR_DISCONNECTED;
 
-    temperature temp = readAndConstrainTemp();
-    requestConversion();
-    return temp;
+    // The conversion is started for the whole bus by OneWireConversionManager.
+    // Only read the scratchpad when a conversion has completed since the last read.
+    if (lastTemp == TEMP_SENSOR_DISCONNECTED || OneWireConversionManager::isConversionCompleteSince(oneWire, lastReadTime))
+    {
+        lastReadTime = ticks.millis();
+        lastTemp = readAndConstrainTemp();
+    }
+    return lastTemp;
 }
 
 temperature OneWireTempSensor::readAndConstrainTemp()
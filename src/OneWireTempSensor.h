@@ -39,6 +39,54 @@ class OneWire;
 
 #define ONEWIRE_TEMP_SENSOR_PRECISION (4)
 
+// Maximum number of OneWire buses with temperature sensors (RevA has two)
+#ifndef ONEWIRE_CONVERSION_MAX_BUSES
+#define ONEWIRE_CONVERSION_MAX_BUSES 2
+#endif
+
+/*
+ * Manages temperature conversions per OneWire bus. Instead of addressing each
+ * sensor separately, one skip-ROM CONVERT T is broadcast per control cycle and
+ * all sensors on the bus convert at the same time. Sensors only read their
+ * scratchpad once the conversion time has passed.
+ */
+class OneWireConversionManager
+{
+  public:
+	/**
+	 * Registers a bus, so it is included in requestConversions(). Registering the same bus twice has no effect.
+	 */
+	static void addBus(OneWire *bus);
+
+	/**
+	 * Starts a conversion on all registered buses that are not already converting.
+	 * Called once per control cycle, after all sensors have been read.
+	 */
+	static void requestConversions();
+
+	/**
+	 * Returns true when no conversion is in progress on the bus, so the scratchpads hold a completed result.
+	 * Buses that are not registered are always reported as complete.
+	 */
+	static bool isConversionComplete(OneWire *bus);
+
+	/**
+	 * Returns true when a conversion that was started at or after the given time has completed.
+	 */
+	static bool isConversionCompleteSince(OneWire *bus, ticks_millis_t time);
+
+  private:
+	struct Bus
+	{
+		OneWire *wire;
+		ticks_millis_t requestTime;
+	};
+
+	static Bus *findBus(OneWire *bus);
+
+	static Bus buses[ONEWIRE_CONVERSION_MAX_BUSES];
+};
+
 class OneWireTempSensor : public BasicTempSensor
 {
   public:
@@ -53,6 +101,8 @@ class OneWireTempSensor : public BasicTempSensor
 		: oneWire(bus), sensor(NULL)
 	{
 		connected = true; // assume connected. Transition from connected to disconnected prints a message.
+		awaitingConversion = false;
+		lastTemp = TEMP_SENSOR_DISCONNECTED;
 		memcpy(sensorAddress, address, sizeof(DeviceAddress));
 		this->calibrationOffset = calibrationOffset;
 	};
@@ -69,11 +119,6 @@ class OneWireTempSensor : public BasicTempSensor
 
   private:
 	void setConnected(bool connected);
-	void requestConversion();
-	void waitForConversion()
-	{
-		wait.millis(750);
-	}
 
 	/**
 	 * Reads the temperature. If successful, constrains the temp to the range of the temperature type and
@@ -87,4 +132,13 @@ class OneWireTempSensor : public BasicTempSensor
 
 	fixed4_4 calibrationOffset;
 	bool connected;
+
+	// Set when the device was re-initialized after a power on reset. Its scratchpad holds the power on value
+	// until a bus conversion started after initTime has completed.
+	bool awaitingConversion;
+	ticks_millis_t initTime;
+
+	// Last value read, returned until the next bus conversion has completed.
+	temperature lastTemp;
+	ticks_millis_t lastReadTime;
 };
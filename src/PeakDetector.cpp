@@ -0,0 +1,94 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "PeakDetector.h"
+
+#if TEMP_SENSOR_PEAK_DETECTOR
+static const temperature_precise noiseBand = Fixed7_9::fromDouble(PEAK_DETECT_NOISE_BAND).widen<7, 25>().raw();
+static const temperature_precise minProminence = Fixed7_9::fromDouble(PEAK_DETECT_MIN_PROMINENCE).widen<7, 25>().raw();
+
+void PeakDetector::init(temperature_precise val)
+{
+	extreme = val;
+	lastTurn = val;
+	previous = val;
+	trend = 0;
+	lastStep = 0;
+	detected = 0;
+}
+
+void PeakDetector::add(temperature_precise val)
+{
+	// a local extremum of three samples, as FixedFilter::detectPosPeak() and detectNegPeak() would report it
+	int8_t step = (val > previous) ? 1 : (val < previous) ? -1 : 0;
+	if (step != 0)
+	{
+		if (step == -lastStep)
+		{
+			extrema++;
+		}
+		lastStep = step;
+	}
+	previous = val;
+	detected = 0;
+
+	if (trend == 0)
+	{
+		// wait until the signal leaves the noise band to know the direction
+		if (val - extreme > noiseBand)
+			trend = 1;
+		else if (extreme - val > noiseBand)
+			trend = -1;
+		else
+			return;
+		lastTurn = extreme;
+		extreme = val;
+		return;
+	}
+
+	temperature_precise distance = (val - extreme) * trend; // positive when moving further in the trend direction
+	if (distance > 0)
+	{
+		extreme = val;
+	}
+	else if (-distance > noiseBand)
+	{
+		// direction changed: the extreme is a peak when it stands out enough from the previous turn
+		if ((extreme - lastTurn) * trend >= minProminence)
+		{
+			detected = trend;
+			accepted++;
+		}
+		lastTurn = extreme;
+		extreme = val;
+		trend = -trend;
+	}
+}
+#endif
@@ -0,0 +1,89 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+
+#if TEMP_SENSOR_PEAK_DETECTOR
+/* Detects peaks in a filtered temperature with hysteresis.
+ *
+ * A positive peak is only accepted after the signal has dropped more than PEAK_DETECT_NOISE_BAND below
+ * its maximum, and when that maximum is at least PEAK_DETECT_MIN_PROMINENCE above the previous valley.
+ * Negative peaks likewise. Small wiggles on a plateau, that three consecutive samples would report as a
+ * peak, are counted as rejected instead.
+ *
+ * A peak is reported for one sample only, by posPeak() or negPeak() after the add() that confirmed it.
+ */
+class PeakDetector
+{
+  public:
+	PeakDetector()
+	{
+		init(0);
+		extrema = 0;
+		accepted = 0;
+	}
+
+	void init(temperature_precise val);
+	void add(temperature_precise val);
+
+	temperature posPeak() const
+	{
+		return (detected > 0) ? tempPreciseToRegular(lastTurn) : INVALID_TEMP;
+	}
+
+	temperature negPeak() const
+	{
+		return (detected < 0) ? tempPreciseToRegular(lastTurn) : INVALID_TEMP;
+	}
+
+	uint16_t acceptedCount() const
+	{
+		return accepted;
+	}
+
+	// local extrema that did not result in a peak
+	uint16_t rejectedCount() const
+	{
+		return extrema - accepted;
+	}
+
+  private:
+	temperature_precise extreme;  // maximum while rising, minimum while falling
+	temperature_precise lastTurn; // value where the direction last changed
+	temperature_precise previous; // previous sample
+	int8_t trend;				  // 1 rising, -1 falling, 0 not known yet
+	int8_t lastStep;			  // direction of the last change of the sample value
+	int8_t detected;			  // 1 positive peak, -1 negative peak, 0 none in the last sample
+	uint16_t extrema; // local extrema of three samples
+	uint16_t accepted;
+};
+#endif
@@ -35,6 +35,7 @@ license and credits. */
 
 #include "Version.h"
 #include "TempControl.h"
+#include "ChamberManager.h"
 #include "Display.h"
 #include "JsonKeys.h"
 #include "Ticks.h"
@@ -45,10 +46,16 @@ license and credits. */
 #include "Display.h"
 #include "PiLinkHandlers.h"
 #include "UI.h"
+#include "TempHistory.h"
 #include "Actuator.h"
 #include "DHT.h"
 #include "HumiditySensor.h"
 #include "FanControl.h"
+#include "LoopProfiler.h"
+#include "Scheduler.h"
+#if BREWPI_BINARY_PILINK
+#include "OneWire.h"
+#endif
 
 #if BREWPI_SIMULATE
 #include "Simulator.h"
@@ -85,6 +92,11 @@ static MockSerial mockSerial;
 #elif !defined(WIRING)
 StdIO stdIO;
 #define piStream stdIO
+#elif PILINK_TX_QUEUE_SIZE
+#define piStream piLinkTxQueue
+#define SERIAL_READY(x) 1
+#define PILINK_TX_MESSAGE(lowPriority) piLinkTxQueue.beginMessage(lowPriority)
+#define PILINK_TX_DRAIN() piLinkTxQueue.drain()
 #else
 #define piStream Serial
 #ifdef SPARK
@@ -94,7 +106,21 @@ StdIO stdIO;
 #endif
 #endif
 
+#ifndef PILINK_TX_MESSAGE
+#define PILINK_TX_MESSAGE(lowPriority)
+#define PILINK_TX_DRAIN()
+#endif
+
 bool PiLink::firstPair;
+#if BREWPI_TEMP_HISTORY
+struct HistoryRequest
+{
+	uint16_t from; // first sample requested with the 'H' command
+	uint8_t count; // maximum number of samples in the response
+};
+static HistoryRequest historyRequest;
+static bool firstHistorySample;
+#endif
 char PiLink::printfBuff[PRINTF_BUFFER_SIZE];
 
 void PiLink::init(void)
@@ -130,6 +156,13 @@ void PiLink::print(char *fmt, ...)
 	}
 }
 
+void PiLink::printQuoted(const char *s)
+{
+	piStream.print('"');
+	piStream.print(s);
+	piStream.print('"');
+}
+
 void PiLink::printNewLine()
 {
 	piStream.println();
@@ -143,9 +176,18 @@ void printNibble(uint8_t n)
 
 void PiLink::receive(void)
 {
+	PILINK_TX_DRAIN();
+	Logger::update();
+	parsingJson(); // checks for a timeout when the host stopped sending
 	while (piStream.available() > 0)
 	{
 		char inByte = piStream.read();
+		if (parsingJson())
+		{
+			// part of the JSON argument of the previous command
+			parseJsonChar(inByte);
+			continue;
+		}
 		switch (inByte)
 		{
 		case ' ':
@@ -217,21 +259,82 @@ void PiLink::receive(void)
 			break;
 		case 'l': // Display content requested
 			printResponse('L');
-			piStream.print('[');
-			char stringBuffer[21];
-			for (uint8_t i = 0; i < 4; i++)
-			{
-				display.getLine(i, stringBuffer);
-				print_P(PSTR("\"%s\""), stringBuffer);
-				char close = (i < 3) ? ',' : ']';
-				piStream.print(close);
-			}
+			printDisplayLines();
 			printNewLine();
 			break;
+#if BREWPI_FULL_STATE_COMMAND
+		case 'f': // Full state requested
+			sendFullState();
+			break;
+#endif
 		case 'j': // Receive settings as json
 			receiveJson();
 			break;
 
+#if BREWPI_CHAMBER_COUNT > 1
+		case 'k': // Selected chamber requested. Select with j{"chamber":n}
+			printChamberInfo();
+			break;
+#endif
+
+#if BREWPI_COMPACT_TELEMETRY
+		case 'm': // Select telemetry format: m{"compact":1} or m{"compact":0}
+			parseJson(&setTelemetryFormat, NULL, &sendTelemetryFormat);
+			break;
+#endif
+
+#if BREWPI_BINARY_PILINK
+		case 'b': // Select binary frames: b{"binary":1} or b{"binary":0}
+			parseJson(&setBinaryMode, NULL, &sendBinaryMode);
+			break;
+#endif
+
+#if BREWPI_TELEMETRY_PUSH
+		case 'u': // Subscribe to pushed telemetry: u{"groups":"ts","period":1,"deadband":0.1}
+			parseJson(&setTelemetrySubscription, NULL, &sendTelemetrySubscription);
+			break;
+#endif
+
+#if BREWPI_TEMP_HISTORY
+		case 'H': // Temperature history requested: H{"from":n,"count":c} sends up to c samples from number n on
+			historyRequest.from = 0;
+			historyRequest.count = TEMP_HISTORY_PAGE_SIZE;
+			parseJson(&setHistoryStart, &historyRequest, &sendHistory);
+			break;
+#endif
+
+		case 'w': // Eeprom write statistics requested
+			printResponse('W');
+			sendJsonPair(JSONKEY_storeRequests, eepromManager.storeRequests);
+			sendJsonPair(JSONKEY_storeCommits, eepromManager.storeCommits);
+			sendJsonClose();
+			break;
+
+#if PILINK_TX_QUEUE_SIZE
+		case 'q': // Output queue statistics requested
+			printResponse('Q');
+			printJsonName(JSONKEY_txQueued);
+			print_P(PSTR("%lu"), PiLinkTxQueue::bytesQueued);
+			printJsonName(JSONKEY_txDropped);
+			print_P(PSTR("%lu"), PiLinkTxQueue::bytesDropped);
+			sendJsonPair(JSONKEY_txPeak, PiLinkTxQueue::peakDepth);
+			sendJsonClose();
+			break;
+#endif
+
+#if TEMP_SENSOR_OUTLIER_WINDOW
+		case 'o': // Rejected sensor readings of the selected chamber requested
+			printResponse('O');
+			sendJsonPair(JSONKEY_beerRejected, tempControl.beerSensor->rejectedSamples());
+			sendJsonPair(JSONKEY_fridgeRejected, tempControl.fridgeSensor->rejectedSamples());
+			sendJsonClose();
+			break;
+#endif
+
+		case 'p': // Loop profiler and task statistics requested
+			sendLoopProfile();
+			break;
+
 #if BREWPI_EEPROM_HELPER_COMMANDS
 		case 'e': // Dump contents of eeprom
 			openListResponse('E');
@@ -262,9 +365,7 @@ void PiLink::receive(void)
 			break;
 
 		case 'd': // List devices in eeprom order
-			openListResponse('d');
 			deviceManager.listDevices(piStream);
-			closeListResponse();
 			break;
 
 		case 'U': // Update device
@@ -272,9 +373,7 @@ void PiLink::receive(void)
 			break;
 
 		case 'h': // Hardware query
-			openListResponse('h');
 			deviceManager.enumerateHardwareToStream(piStream);
-			closeListResponse();
 			break;
 
 #if (BREWPI_DEBUG > 0)
@@ -285,6 +384,7 @@ void PiLink::receive(void)
 #endif
 
 		case 'R': // reset
+			eepromManager.commitTempSettings();
 			handleReset();
 			break;
 
@@ -298,112 +398,418 @@ void PiLink::receive(void)
 	}
 }
 
-#define COMPACT_SERIAL BREWPI_SIMULATE
-#if COMPACT_SERIAL
-#define JSON_BEER_TEMP "bt"
-#define JSON_BEER_SET "bs"
-#define JSON_BEER_ANN "ba"
-#define JSON_FRIDGE_TEMP "ft"
-#define JSON_FRIDGE_SET "fs"
-#define JSON_FRIDGE_ANN "fa"
-#define JSON_FRIDGE_HUMIDITY "fh"
-#define JSON_STATE "s"
-#define JSON_TIME "t"
-#define JSON_ROOM_TEMP "rt"
+// Keys of the temperature line in the verbose format, used by the existing scripts.
+#define JSON_BEER_TEMP "BeerTemp"
+#define JSON_BEER_SET "BeerSet"
+#define JSON_BEER_ANN "BeerAnn"
+#define JSON_FRIDGE_TEMP "FridgeTemp"
+#define JSON_FRIDGE_HUMIDITY "FridgeHumidity"
+#define JSON_FRIDGE_SET "FridgeSet"
+#define JSON_FRIDGE_ANN "FridgeAnn"
+#define JSON_STATE "State"
+#define JSON_TIME "Time"
+#define JSON_ROOM_TEMP "RoomTemp"
 
-temperature beerTemp = -1, beerSet = -1, fridgeTemp = -1, fridgeSet = -1, fridgeHumidity = -1;
-double roomTemp = -1;
-uint8_t state = 0xFF;
-char *beerAnn;
-char *fridgeAnn;
+#if BREWPI_COMPACT_TELEMETRY
+// Keys in the compact format. Only values that changed since the previous temperature line are sent,
+// and annotations are only sent when there is one.
+#define JSON_COMPACT_BEER_TEMP "bt"
+#define JSON_COMPACT_BEER_SET "bs"
+#define JSON_COMPACT_BEER_ANN "ba"
+#define JSON_COMPACT_FRIDGE_TEMP "ft"
+#define JSON_COMPACT_FRIDGE_SET "fs"
+#define JSON_COMPACT_FRIDGE_ANN "fa"
+#define JSON_COMPACT_FRIDGE_HUMIDITY "fh"
+#define JSON_COMPACT_STATE "s"
+#define JSON_COMPACT_TIME "t"
+#define JSON_COMPACT_ROOM_TEMP "rt"
+
+bool PiLink::compactTelemetry = BREWPI_SIMULATE;
+
+// Values in the last temperature line. Only used in compact mode.
+static temperature beerTemp, beerSet, fridgeTemp, fridgeSet, roomTemp;
+static humidity fridgeHumidity;
+static uint8_t state;
+static bool sendAllTemperatures = true;
 
-typedef char *PChar;
 inline bool changed(uint8_t &a, uint8_t b)
 {
 	uint8_t c = a;
 	a = b;
-	return b != c;
+	return b != c || sendAllTemperatures || !PiLink::compactTelemetry;
 }
 inline bool changed(temperature &a, temperature b)
 {
 	temperature c = a;
 	a = b;
-	return b != c;
+	return b != c || sendAllTemperatures || !PiLink::compactTelemetry;
 }
-inline bool changed(double &a, double b)
+
+#define JSON_TEMP_KEY(name) (compactTelemetry ? PSTR(JSON_COMPACT_##name) : PSTR(JSON_##name))
+#define sendAnnotation(annotation) ((annotation) || !compactTelemetry)
+
+// Handles m{"compact":1}. The next temperature line after a switch contains all values.
+void PiLink::setTelemetryFormat(const char *key, const char *val, void *data)
 {
-	double c = a;
-	a = b;
-	return b != c;
+	if (strcmp_P(key, JSONKEY_compact) == 0)
+	{
+		compactTelemetry = atoi(val) != 0;
+		sendAllTemperatures = true;
+	}
 }
-inline bool changed(PChar &a, PChar b)
+
+void PiLink::sendTelemetryFormat(void *data)
 {
-	PChar c = a;
-	a = b;
-	return b != c;
+	printResponse('M');
+	sendJsonPair(JSONKEY_compact, (uint8_t)compactTelemetry);
+	sendJsonClose();
 }
 #else
-#define JSON_BEER_TEMP "BeerTemp"
-#define JSON_BEER_SET "BeerSet"
-#define JSON_BEER_ANN "BeerAnn"
-#define JSON_FRIDGE_TEMP "FridgeTemp"
-#define JSON_FRIDGE_HUMIDITY "FridgeHumidity"
-#define JSON_FRIDGE_SET "FridgeSet"
-#define JSON_FRIDGE_ANN "FridgeAnn"
-#define JSON_STATE "State"
-#define JSON_TIME "Time"
-#define JSON_ROOM_TEMP "RoomTemp"
-
+#define JSON_TEMP_KEY(name) PSTR(JSON_##name)
+#define sendAnnotation(annotation) 1
 #define changed(a, b) 1
 #endif
 
-void PiLink::printTemperaturesJSON(char *beerAnnotation, char *fridgeAnnotation)
+#if BREWPI_TELEMETRY_PUSH
+// Values in the last temperature line, compared with the deadband of the subscription
+enum
+{
+	PUSHED_BEER_TEMP,
+	PUSHED_BEER_SET,
+	PUSHED_FRIDGE_TEMP,
+	PUSHED_FRIDGE_SET,
+	PUSHED_ROOM_TEMP,
+	PUSHED_FRIDGE_HUMIDITY,
+	PUSHED_VALUES
+};
+static temperature pushedValues[PUSHED_VALUES];
+static uint8_t pushedState;
+
+// Letters of the groups in the 'u' command, in the bit order of PiLink::TelemetryGroups
+static const char TELEMETRY_GROUP_LETTERS[] PROGMEM = "tsvh";
+
+static uint8_t subscribedGroups; // 0 when the host polls
+static bool pushNext;			 // push at the next tick, even when nothing moved
+static uint8_t pushPeriod = 1;	 // control ticks between pushes
+static uint8_t ticksToPush = 1;
+static temperature pushDeadband;
+static humidity pushHumidityDeadband;
+
+// Remembers the values of the groups in a temperature line
+static void recordSentValues(uint8_t groups)
+{
+	if (groups & PiLink::TELEMETRY_TEMPS)
+	{
+		pushedValues[PUSHED_BEER_TEMP] = tempControl.getBeerTemp();
+		pushedValues[PUSHED_BEER_SET] = tempControl.getBeerSetting();
+		pushedValues[PUSHED_FRIDGE_TEMP] = tempControl.getFridgeTemp();
+		pushedValues[PUSHED_FRIDGE_SET] = tempControl.getFridgeSetting();
+		pushedValues[PUSHED_ROOM_TEMP] = tempControl.getRoomTemp();
+	}
+	if (groups & PiLink::TELEMETRY_STATE)
+		pushedState = tempControl.getState();
+	if (groups & PiLink::TELEMETRY_HUMIDITY)
+		pushedValues[PUSHED_FRIDGE_HUMIDITY] = tempControl.getFridgeHumidity();
+}
+
+static bool moved(uint8_t index, temperature value, temperature deadband)
+{
+	long_temperature diff = long_temperature(value) - pushedValues[index];
+	return diff > deadband || diff < -deadband;
+}
+
+static bool subscribedValuesMoved()
 {
+	if ((subscribedGroups & PiLink::TELEMETRY_STATE) && tempControl.getState() != pushedState)
+		return true;
+	if (subscribedGroups & PiLink::TELEMETRY_TEMPS)
+	{
+		if (moved(PUSHED_BEER_TEMP, tempControl.getBeerTemp(), pushDeadband) ||
+			moved(PUSHED_BEER_SET, tempControl.getBeerSetting(), pushDeadband) ||
+			moved(PUSHED_FRIDGE_TEMP, tempControl.getFridgeTemp(), pushDeadband) ||
+			moved(PUSHED_FRIDGE_SET, tempControl.getFridgeSetting(), pushDeadband) ||
+			(tempControl.ambientSensor->isConnected() && moved(PUSHED_ROOM_TEMP, tempControl.getRoomTemp(), pushDeadband)))
+			return true;
+	}
+	return (subscribedGroups & PiLink::TELEMETRY_HUMIDITY) &&
+		   moved(PUSHED_FRIDGE_HUMIDITY, tempControl.getFridgeHumidity(), pushHumidityDeadband);
+}
+
+void PiLink::pushTelemetry(void)
+{
+	if (!subscribedGroups || --ticksToPush)
+		return;
+	ticksToPush = pushPeriod;
+	if (pushNext || subscribedValuesMoved())
+	{
+		pushNext = false;
+		printTemperaturesJSON(0, 0, subscribedGroups | TELEMETRY_TIME);
+	}
+	if (subscribedGroups & TELEMETRY_VARIABLES)
+		sendControlVariables();
+}
+
+// Handles u{"groups":"tsvh","period":5,"deadband":0.1,"humDeadband":1}. Groups are t(emperatures), s(tate),
+// v(ariables) and h(umidity); an empty string ends the subscription. The period is in control ticks (seconds).
+// The deadbands are a temperature difference and a humidity in percent.
+void PiLink::setTelemetrySubscription(const char *key, const char *val, void *data)
+{
+	if (strcmp_P(key, JSONKEY_groups) == 0)
+	{
+		uint8_t groups = 0;
+		for (; *val; val++)
+		{
+			const char *group = strchr_P(TELEMETRY_GROUP_LETTERS, *val);
+			if (group)
+				groups |= 1 << (group - TELEMETRY_GROUP_LETTERS);
+		}
+		subscribedGroups = groups;
+		ticksToPush = 1;
+		pushNext = true;
+	}
+	else if (strcmp_P(key, JSONKEY_period) == 0)
+	{
+		long period = atol(val);
+		pushPeriod = constrain(period, 1, 255);
+	}
+	else if (strcmp_P(key, JSONKEY_deadband) == 0)
+	{
+		stringToTempDiff(&pushDeadband, val);
+	}
+	else if (strcmp_P(key, JSONKEY_humidityDeadband) == 0)
+	{
+		stringToFixedPoint(&pushHumidityDeadband, val);
+	}
+}
+
+void PiLink::sendTelemetrySubscription(void *data)
+{
+	char tempString[12];
+	printResponse('U');
+	printJsonName(JSONKEY_groups);
+	piStream.print('"');
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		if (subscribedGroups & (1 << i))
+		{
+			piStream.print((char)pgm_read_byte(TELEMETRY_GROUP_LETTERS + i));
+		}
+	}
+	piStream.print('"');
+	sendJsonPair(JSONKEY_period, pushPeriod);
+	tempDiffToString(tempString, pushDeadband, 3, sizeof(tempString));
+	printJsonName(JSONKEY_deadband);
+	piStream.print(tempString);
+	fixedPointToString(tempString, pushHumidityDeadband, 3, sizeof(tempString));
+	printJsonName(JSONKEY_humidityDeadband);
+	piStream.print(tempString);
+	sendJsonClose();
+}
+#endif
+
+// Only the groups in the mask are sent. Polled lines contain all of them.
+void PiLink::printTemperaturesJSON(char *beerAnnotation, char *fridgeAnnotation, uint8_t groups)
+{
+#if BREWPI_BINARY_PILINK
+	if (binaryMode)
+	{
+#if BREWPI_TELEMETRY_PUSH
+		recordSentValues(groups);
+#endif
+		sendTemperaturesFrame(beerAnnotation, fridgeAnnotation);
+		return;
+	}
+#endif
 	printResponse('T');
+	printTemperaturePairs(beerAnnotation, fridgeAnnotation, groups);
+	if (firstPair)
+	{
+		// nothing changed, still send a valid JSON object
+		piStream.print('{');
+	}
+	sendJsonClose();
+}
 
+void PiLink::printTemperaturePairs(char *beerAnnotation, char *fridgeAnnotation, uint8_t groups)
+{
+#if BREWPI_TELEMETRY_PUSH
+	recordSentValues(groups);
+#endif
 	temperature t;
-	t = tempControl.getBeerTemp();
-	if (changed(beerTemp, t))
-		sendJsonTemp(PSTR(JSON_BEER_TEMP), t);
-
-	t = tempControl.getBeerSetting();
-	if (changed(beerSet, t))
-		sendJsonTemp(PSTR(JSON_BEER_SET), t);
+	if (groups & TELEMETRY_TEMPS)
+	{
+		t = tempControl.getBeerTemp();
+		if (changed(beerTemp, t))
+			sendJsonTemp(JSON_TEMP_KEY(BEER_TEMP), t);
 
-	if (changed(beerAnn, beerAnnotation))
-		sendJsonAnnotation(PSTR(JSON_BEER_ANN), beerAnnotation);
+		t = tempControl.getBeerSetting();
+		if (changed(beerSet, t))
+			sendJsonTemp(JSON_TEMP_KEY(BEER_SET), t);
 
-	t = tempControl.getFridgeTemp();
-	if (changed(fridgeTemp, t))
-		sendJsonTemp(PSTR(JSON_FRIDGE_TEMP), t);
+		if (sendAnnotation(beerAnnotation))
+			sendJsonAnnotation(JSON_TEMP_KEY(BEER_ANN), beerAnnotation);
 
-	t = tempControl.getFridgeSetting();
-	if (changed(fridgeSet, t))
-		sendJsonTemp(PSTR(JSON_FRIDGE_SET), t);
+		t = tempControl.getFridgeTemp();
+		if (changed(fridgeTemp, t))
+			sendJsonTemp(JSON_TEMP_KEY(FRIDGE_TEMP), t);
 
-	if (changed(fridgeAnn, fridgeAnnotation))
-		sendJsonAnnotation(PSTR(JSON_FRIDGE_ANN), fridgeAnnotation);
+		t = tempControl.getFridgeSetting();
+		if (changed(fridgeSet, t))
+			sendJsonTemp(JSON_TEMP_KEY(FRIDGE_SET), t);
 
-	t = tempControl.getRoomTemp();
-	if (tempControl.ambientSensor->isConnected() && changed(roomTemp, t))
-		sendJsonTemp(PSTR(JSON_ROOM_TEMP), tempControl.getRoomTemp());
+		if (sendAnnotation(fridgeAnnotation))
+			sendJsonAnnotation(JSON_TEMP_KEY(FRIDGE_ANN), fridgeAnnotation);
 
-	if (changed(state, tempControl.getState()))
-		sendJsonPair(PSTR(JSON_STATE), (uint8_t)tempControl.getState());
+		t = tempControl.getRoomTemp();
+		if (tempControl.ambientSensor->isConnected() && changed(roomTemp, t))
+			sendJsonTemp(JSON_TEMP_KEY(ROOM_TEMP), t);
+	}
 
-	humidity h;
-	h = tempControl.getFridgeHumidity();
-	if (changed(fridgeHumidity, h))
-		sendJsonTemp(PSTR(JSON_FRIDGE_HUMIDITY), h);
+	if (groups & TELEMETRY_STATE)
+	{
+		if (changed(state, tempControl.getState()))
+			sendJsonPair(JSON_TEMP_KEY(STATE), (uint8_t)tempControl.getState());
+	}
 
+	if (groups & TELEMETRY_HUMIDITY)
+	{
+		humidity h;
+		h = tempControl.getFridgeHumidity();
+		if (changed(fridgeHumidity, h))
+			sendJsonTemp(JSON_TEMP_KEY(FRIDGE_HUMIDITY), h);
+	}
 
-#if BREWPI_SIMULATE
-	printJsonName(PSTR(JSON_TIME));
-	print_P(PSTR("%lu"), ticks.millis() / 1000);
+#if !BREWPI_SIMULATE
+	if (groups & TELEMETRY_TIME)
 #endif
+	{
+		printJsonName(JSON_TEMP_KEY(TIME));
+		print_P(PSTR("%lu"), ticks.millis() / 1000);
+	}
+#if BREWPI_COMPACT_TELEMETRY
+	if ((groups & (TELEMETRY_TEMPS | TELEMETRY_STATE | TELEMETRY_HUMIDITY)) == (TELEMETRY_TEMPS | TELEMETRY_STATE | TELEMETRY_HUMIDITY))
+	{
+		// after a line with only some groups, the next line must still contain all values of the others
+		sendAllTemperatures = false;
+	}
+#endif
+}
+
+#if BREWPI_BINARY_PILINK
+/*
+ * Binary frames replace the JSON lines for temperatures ('T'), annotations ('N'), settings ('S'),
+ * constants ('C'), variables ('V') and log messages ('D'). Other replies stay JSON lines.
+ * A frame is: 0xA5, type, payload length, payload, CRC-16 (low byte first).
+ * The CRC is the 1-Wire CRC-16 over type, length and payload. 0xA5 can occur inside a payload, so
+ * it only marks a candidate frame: after a corrupted frame the host resyncs by trying each 0xA5,
+ * reading the length field and accepting the frame only when its CRC matches.
+ * Values are little-endian, temperatures are raw fixed7_9. Settings, constants and variables
+ * are sent as the ControlSettings (followed by FanControlSettings), ControlConstants and
+ * ControlVariables structs.
+ */
+#define PILINK_FRAME_SYNC 0xA5
+
+bool PiLink::binaryMode;
+uint16_t PiLink::frameCrc;
+
+// Handles b{"binary":1}
+void PiLink::setBinaryMode(const char *key, const char *val, void *data)
+{
+	if (strcmp_P(key, JSONKEY_binary) == 0)
+	{
+		binaryMode = atoi(val) != 0;
+	}
+}
+
+void PiLink::sendBinaryMode(void *data)
+{
+	printResponse('B');
+	sendJsonPair(JSONKEY_binary, (uint8_t)binaryMode);
 	sendJsonClose();
 }
 
+void PiLink::beginFrame(char type, uint8_t length)
+{
+	uint8_t header[2] = {(uint8_t)type, length};
+	PILINK_TX_MESSAGE(type == 'D');
+	piStream.write(PILINK_FRAME_SYNC);
+	piStream.write(header[0]);
+	piStream.write(header[1]);
+	frameCrc = OneWire::crc16(header, sizeof(header), 0);
+}
+
+void PiLink::writeFrameBytes(const void *data, uint8_t length)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	frameCrc = OneWire::crc16(p, length, frameCrc);
+	while (length--)
+	{
+		piStream.write(*p++);
+	}
+}
+
+void PiLink::endFrame()
+{
+	piStream.write(uint8_t(frameCrc));
+	piStream.write(uint8_t(frameCrc >> 8));
+	PILINK_TX_MESSAGE(false);
+}
+
+void PiLink::sendFrame(char type, const void *payload, uint8_t length)
+{
+	beginFrame(type, length);
+	writeFrameBytes(payload, length);
+	endFrame();
+}
+
+struct BinaryTemperatures
+{
+	temperature beerTemp;
+	temperature beerSet;
+	temperature fridgeTemp;
+	temperature fridgeSet;
+	temperature roomTemp; // INVALID_TEMP when no room sensor is connected
+	humidity fridgeHumidity;
+	uint8_t state;
+};
+
+static void sendAnnotationFrame(uint8_t target, const char *annotation)
+{
+	uint8_t length = strlen(annotation);
+	PiLink::beginFrame('N', length + 1);
+	PiLink::writeFrameBytes(&target, 1);
+	PiLink::writeFrameBytes(annotation, length);
+	PiLink::endFrame();
+}
+
+// Annotations follow the temperatures in an 'N' frame: 0 (beer) or 1 (fridge), then the text.
+void PiLink::sendTemperaturesFrame(const char *beerAnnotation, const char *fridgeAnnotation)
+{
+	BinaryTemperatures temps;
+	temps.beerTemp = tempControl.getBeerTemp();
+	temps.beerSet = tempControl.getBeerSetting();
+	temps.fridgeTemp = tempControl.getFridgeTemp();
+	temps.fridgeSet = tempControl.getFridgeSetting();
+	temps.roomTemp = tempControl.ambientSensor->isConnected() ? tempControl.getRoomTemp() : INVALID_TEMP;
+	temps.fridgeHumidity = tempControl.getFridgeHumidity();
+	temps.state = tempControl.getState();
+	sendFrame('T', &temps, sizeof(temps));
+
+	if (beerAnnotation)
+		sendAnnotationFrame(0, beerAnnotation);
+	if (fridgeAnnotation)
+		sendAnnotationFrame(1, fridgeAnnotation);
+}
+
+// Log payload: log type, log id, then each value as its type character followed by the value.
+// Integers, temperatures and fixed point values are 2 bytes, strings are 0 terminated.
+void PiLink::sendLogFrame(char type, uint8_t errorID, const char *varTypes, va_list args)
+{
+	uint8_t length = Logger::encodeRecord((uint8_t *)printfBuff, PRINTF_BUFFER_SIZE, type, errorID, varTypes, args);
+	sendFrame('D', printfBuff, length);
+}
+#endif
+
 void PiLink::sendJsonAnnotation(const char *name, const char *annotation)
 {
 	printJsonName(name);
@@ -459,6 +865,7 @@ void PiLink::printFridgeAnnotation(const char *annotation, ...)
 
 void PiLink::printResponse(char type)
 {
+	PILINK_TX_MESSAGE(type == 'D'); // log messages may be dropped when the output queue is full
 	piStream.print(type);
 	piStream.print(':');
 	firstPair = true;
@@ -505,8 +912,26 @@ void PiLink::sendJsonClose()
 // Send settings as JSON string
 void PiLink::sendControlSettings(void)
 {
-	char tempString[12];
+#if BREWPI_BINARY_PILINK
+	ControlSettings &cs = tempControl.cs;
+	FanControlSettings &fcs = fanControl.cs;
+	if (binaryMode)
+	{
+		beginFrame('S', sizeof(cs) + sizeof(fcs));
+		writeFrameBytes(&cs, sizeof(cs));
+		writeFrameBytes(&fcs, sizeof(fcs));
+		endFrame();
+		return;
+	}
+#endif
 	printResponse('S');
+	printControlSettings();
+	sendJsonClose();
+}
+
+void PiLink::printControlSettings(void)
+{
+	char tempString[12];
 	ControlSettings &cs = tempControl.cs;
 	FanControlSettings &fcs = fanControl.cs;
 	sendJsonPair(JSONKEY_mode, cs.mode);
@@ -515,7 +940,6 @@ void PiLink::sendControlSettings(void)
 	sendJsonPair(JSONKEY_fanDuty, tempToString(tempString, fcs.fanSetting, 2, 12));
 	sendJsonPair(JSONKEY_heatEstimator, fixedPointToString(tempString, cs.heatEstimator, 3, 12));
 	sendJsonPair(JSONKEY_coolEstimator, fixedPointToString(tempString, cs.coolEstimator, 3, 12));
-	sendJsonClose();
 }
 
 // Location to which the offset is relative. This saves having to store a
@@ -628,19 +1052,31 @@ const PiLink::JsonOutput PiLink::jsonOutputCCMap[] PROGMEM = {
 void PiLink::sendJsonValues(char responseType, const JsonOutput * /*PROGMEM*/ jsonOutputMap, uint8_t mapCount)
 {
 	printResponse(responseType);
+	printJsonValues(jsonOutputMap, mapCount);
+	sendJsonClose();
+}
+
+void PiLink::printJsonValues(const JsonOutput * /*PROGMEM*/ jsonOutputMap, uint8_t mapCount)
+{
 	while (mapCount-- > 0)
 	{
 		JsonOutput output;
 		memcpy_P(&output, jsonOutputMap++, sizeof(output));
 		JsonOutputHandlers[output.handlerOffset](output.key, output.offset);
 	}
-	sendJsonClose();
 }
 
 // Send control constants as JSON string. Might contain spaces between minus
 // sign and number. Python will have to strip these.
 void PiLink::sendControlConstants(void)
 {
+#if BREWPI_BINARY_PILINK
+	if (binaryMode)
+	{
+		sendFrame('C', &tempControl.cc, sizeof(tempControl.cc));
+		return;
+	}
+#endif
 	jsonOutputBase = (uint8_t *)&tempControl.cc;
 	sendJsonValues('C', jsonOutputCCMap, sizeof(jsonOutputCCMap) / sizeof(jsonOutputCCMap[0]));
 }
@@ -661,10 +1097,200 @@ const PiLink::JsonOutput PiLink::jsonOutputCVMap[] PROGMEM = {
 // Send all control variables. Useful for debugging and choosing parameters
 void PiLink::sendControlVariables(void)
 {
+#if BREWPI_BINARY_PILINK
+	if (binaryMode)
+	{
+		sendFrame('V', &tempControl.cv, sizeof(tempControl.cv));
+		return;
+	}
+#endif
 	jsonOutputBase = (uint8_t *)&tempControl.cv;
 	sendJsonValues('V', jsonOutputCVMap, sizeof(jsonOutputCVMap) / sizeof(jsonOutputCVMap[0]));
 }
 
+// Prints the four lines of the display as a JSON array of strings
+void PiLink::printDisplayLines(void)
+{
+	piStream.print('[');
+	char stringBuffer[21];
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		display.getLine(i, stringBuffer);
+		print_P(PSTR("\"%s\""), stringBuffer);
+		char close = (i < 3) ? ',' : ']';
+		piStream.print(close);
+	}
+}
+
+#if BREWPI_FULL_STATE_COMMAND
+// Starts a JSON object as the value of a pair. The pairs in it are printed as usual.
+void PiLink::openJsonObject(const char *name)
+{
+	printJsonName(name);
+	firstPair = true;
+}
+
+void PiLink::closeJsonObject(void)
+{
+	if (firstPair)
+	{
+		// empty object
+		piStream.print('{');
+	}
+	piStream.print('}');
+	firstPair = false;
+}
+
+// Sends everything the script shows in one response, instead of the replies to s, c, v, t and l:
+// F:{"settings":{..},"constants":{..},"variables":{..},"temps":{..},"wait":12,"lcd":["..","..","..",".."]}
+// The objects contain the same pairs as those replies. The reply is JSON, also in binary mode.
+void PiLink::sendFullState(void)
+{
+	printResponse('F');
+
+	openJsonObject(JSONKEY_settings);
+	printControlSettings();
+	closeJsonObject();
+
+	openJsonObject(JSONKEY_constants);
+	jsonOutputBase = (uint8_t *)&tempControl.cc;
+	printJsonValues(jsonOutputCCMap, sizeof(jsonOutputCCMap) / sizeof(jsonOutputCCMap[0]));
+	closeJsonObject();
+
+	openJsonObject(JSONKEY_variables);
+	jsonOutputBase = (uint8_t *)&tempControl.cv;
+	printJsonValues(jsonOutputCVMap, sizeof(jsonOutputCVMap) / sizeof(jsonOutputCVMap[0]));
+	closeJsonObject();
+
+	openJsonObject(JSONKEY_temps);
+#if BREWPI_COMPACT_TELEMETRY
+	sendAllTemperatures = true; // the snapshot contains all values, also in compact mode
+#endif
+	printTemperaturePairs(0, 0, TELEMETRY_ALL);
+	closeJsonObject();
+
+	sendJsonPair(JSONKEY_waitTime, uint16_t(tempControl.getWaitTime()));
+	printJsonName(JSONKEY_lcd);
+	printDisplayLines();
+	sendJsonClose();
+}
+#endif
+
+#if BREWPI_CHAMBER_COUNT > 1
+// Chambers are numbered from 1, like the chamber of a device.
+void PiLink::printChamberInfo(void)
+{
+	printResponse('K');
+	sendJsonPair(JSONKEY_chamber, (uint8_t)(ChamberManager::selectedChamber() + 1));
+	sendJsonPair(JSONKEY_chamberCount, ChamberManager::chamberCount());
+	sendJsonClose();
+}
+#endif
+
+#if BREWPI_TEMP_HISTORY
+void PiLink::setHistoryStart(const char *key, const char *val, void *data)
+{
+	HistoryRequest *request = (HistoryRequest *)data;
+	if (strcmp_P(key, JSONKEY_historyFrom) == 0)
+	{
+		request->from = strtoul(val, NULL, 10);
+	}
+	else if (strcmp_P(key, JSONKEY_historyCount) == 0)
+	{
+		request->count = min(strtoul(val, NULL, 10), 255ul);
+	}
+}
+
+// Sends H:{"interval":1200,"age":12,"next":1234,"from":1210,"samples":[[beer,fridge,room,state],...]}
+// The last sample is number next-1 and was taken age seconds ago. The first sample in the response is number from.
+// To page through the history, request again from from + the number of samples until it reaches next.
+void PiLink::sendHistory(void *data)
+{
+	HistoryRequest *request = (HistoryRequest *)data;
+	// samples older than the oldest one are no longer available
+	uint16_t from = TempHistory::firstSequence();
+	if (int16_t(request->from - from) > 0)
+	{
+		from = request->from;
+	}
+	printResponse('H');
+	sendJsonPair(JSONKEY_historyInterval, uint16_t(TEMP_HISTORY_INTERVAL));
+	sendJsonPair(JSONKEY_historyAge, uint16_t(TempHistory::age()));
+	sendJsonPair(JSONKEY_historyNext, uint16_t(TempHistory::firstSequence() + TempHistory::sampleCount()));
+	sendJsonPair(JSONKEY_historyFrom, from);
+	printJsonName(JSONKEY_historySamples);
+	piStream.print('[');
+	firstHistorySample = true;
+	TempHistory::forEach(from, request->count, &printHistorySample);
+	piStream.print(']');
+	sendJsonClose();
+}
+
+void PiLink::printHistorySample(uint16_t sequence, const temperature *temps, uint8_t state)
+{
+	char tempString[9];
+	if (!firstHistorySample)
+	{
+		piStream.print(',');
+	}
+	firstHistorySample = false;
+	piStream.print('[');
+	for (uint8_t i = 0; i < NUM_HISTORY_CHANNELS; i++)
+	{
+		piStream.print(tempToString(tempString, temps[i], 2, 9));
+		piStream.print(',');
+	}
+	piStream.print(state);
+	piStream.print(']');
+}
+#endif
+
+#if BREWPI_LOOP_PROFILER
+// Keys in the same order as enum ProfilerStage
+static const char *const profilerStageKeys[NUM_PROFILER_STAGES] PROGMEM = {
+	JSONKEY_profileTemperatures,
+	JSONKEY_profilePeaks,
+	JSONKEY_profilePID,
+	JSONKEY_profileState,
+	JSONKEY_profileOutputs,
+	JSONKEY_profileUI,
+	JSONKEY_profileReceive};
+#endif
+
+/* Send the loop profiler statistics, when enabled, and the task statistics, and reset them. Times of the profiler
+ * are in microseconds. "tasks" holds [overruns, worst lateness in milliseconds] for each task, in the order of
+ * enum BrewpiTasks in Brewpi.cpp.
+ */
+void PiLink::sendLoopProfile(void)
+{
+	printResponse('P');
+#if BREWPI_LOOP_PROFILER
+	for (uint8_t i = 0; i < NUM_PROFILER_STAGES; i++)
+	{
+		const char *key;
+		memcpy_P(&key, &profilerStageKeys[i], sizeof(key));
+		const ProfilerStats &stats = LoopProfiler::getStats(i);
+		printJsonName(key);
+		print_P(PSTR("{\"n\":%lu,\"min\":%lu,\"max\":%lu,\"avg\":%lu}"),
+				stats.count, stats.min, stats.max, stats.count ? stats.total / stats.count : 0);
+	}
+	LoopProfiler::reset();
+#endif
+	printJsonName(JSONKEY_profileTasks);
+	piStream.print('[');
+	for (uint8_t i = 0; i < brewpiTaskCount; i++)
+	{
+		if (i)
+		{
+			piStream.print(',');
+		}
+		print_P(PSTR("[%u,%u]"), brewpiTaskStats[i].overruns, brewpiTaskStats[i].maxLateness);
+	}
+	piStream.print(']');
+	sendJsonClose();
+	Scheduler::resetStats(brewpiTaskStats, brewpiTaskCount);
+}
+
 void PiLink::printJsonName(const char *name)
 {
 	printJsonSeparator();
@@ -705,126 +1331,258 @@ void PiLink::sendJsonPair(const char *name, uint8_t val)
 	sendJsonPair(name, (uint16_t)val);
 }
 
-int readNext()
+/*
+ * JSON arguments of commands are parsed incrementally as the bytes arrive in receive(), so a slow
+ * host never blocks the control loop. Only flat objects with values without ',' and ':' are supported.
+ * Each key/value pair is passed to the callback of the command, and the complete callback is called
+ * after the closing brace. While an object is being parsed, no other commands are processed.
+ */
+enum JsonParseState
 {
-	uint16_t retries = 0;
-	while (piStream.available() == 0)
+	JSON_IDLE,
+	JSON_EXPECT_BRACE,
+	JSON_KEY,
+	JSON_VALUE
+};
+
+#define JSON_TOKEN_SIZE 30
+#define JSON_TIMEOUT_MILLIS 1000 // abandon an incomplete object when no data arrives for this long
+
+struct JsonParser
+{
+	PiLink::ParseJsonCallback fn;
+	PiLink::JsonCompleteCallback complete;
+	void *data;
+	ticks_millis_t lastReceived;
+	uint8_t state;
+	uint8_t index;
+	bool truncated;
+	char key[JSON_TOKEN_SIZE];
+	char val[JSON_TOKEN_SIZE];
+};
+
+static JsonParser jsonParser;
+
+void PiLink::parseJson(ParseJsonCallback fn, void *data, JsonCompleteCallback complete)
+{
+	jsonParser.fn = fn;
+	jsonParser.complete = complete;
+	jsonParser.data = data;
+	jsonParser.lastReceived = ticks.millis();
+	jsonParser.state = JSON_EXPECT_BRACE;
+}
+
+void PiLink::completeJson(void)
+{
+	jsonParser.state = JSON_IDLE;
+	if (jsonParser.complete)
+	{
+		jsonParser.complete(jsonParser.data);
+	}
+}
+
+bool PiLink::parsingJson(void)
+{
+	if (jsonParser.state != JSON_IDLE && ticks.millis() - jsonParser.lastReceived > JSON_TIMEOUT_MILLIS)
 	{
-		wait.microseconds(100);
-		retries++;
-		if (retries >= 10000)
+		// the host stopped sending. Process what was received, like a closing brace.
+		logWarning(WARNING_JSON_TIMEOUT);
+		completeJson();
+	}
+	return jsonParser.state != JSON_IDLE;
+}
+
+void PiLink::parseJsonChar(char c)
+{
+	JsonParser &p = jsonParser;
+	p.lastReceived = ticks.millis();
+
+	if (p.state == JSON_EXPECT_BRACE)
+	{
+		if (c != '{')
 		{
-			return -1;
+			logErrorInt(ERROR_EXPECTED_BRACKET, c);
+			completeJson();
+			return;
 		}
+		p.state = JSON_KEY;
+		p.index = 0;
+		p.truncated = false;
+		return;
 	}
-	return piStream.read();
-}
 
-bool parseJsonToken(char *val)
-{  // Parses a token from the piStream, return true if a token was parsed
-	uint8_t index = 0;
-	val[0] = 0;
-	bool result = true;
-	for (;;) // get value
+	char *token = (p.state == JSON_KEY) ? p.key : p.val;
+	if (c == ',' || c == ':' || c == '}') // end of token
 	{
-		int character = readNext();
-		if (index == 29 || character == '}' || character == -1)
+		token[p.index] = 0;
+		p.index = 0;
+		if (p.state == JSON_KEY && c != '}')
 		{
-			result = false;
-			break;
+			p.state = JSON_VALUE;
+			return;
 		}
-		if (character == ',' || character == ':') // End of value
-			break;
-		if (character == ' ' || character == '"')
+		if (p.state == JSON_VALUE)
+		{
+			if (p.truncated)
+			{
+				logWarningIntString(WARNING_JSON_TOKEN_TRUNCATED, JSON_TOKEN_SIZE - 1, p.key);
+			}
+			else if (p.key[0] && p.val[0])
+			{
+				p.fn(p.key, p.val, p.data);
+			}
+			p.truncated = false;
+			p.state = JSON_KEY;
+		}
+		if (c == '}')
 		{
-			; // Skip spaces and apostrophes
+			completeJson();
 		}
-		else
-			val[index++] = character;
+		return;
 	}
-	val[index] = 0; // Null terminate string
-	return result;
-}
-
-void PiLink::parseJson(ParseJsonCallback fn, void *data)
-{
-	char key[30];
-	char val[30];
-	*key = 0;
-	*val = 0;
-	bool next = true;
-	// Read first open brace
-	int c = readNext();
-	if (c != '{')
+	if (c == ' ' || c == '"')
 	{
-		logErrorInt(ERROR_EXPECTED_BRACKET, c);
-		return;
+		return; // Skip spaces and quotes
 	}
-	do
+	if (p.index < JSON_TOKEN_SIZE - 1)
 	{
-		next = parseJsonToken(key) && parseJsonToken(val);
-		if (val[0] && key[0])
-			fn(key, val, data);
-	} while (next);
+		token[p.index++] = c;
+	}
+	else
+	{
+		p.truncated = true; // reported when the pair is complete, the pair is not applied
+	}
 }
 
 void PiLink::receiveJson(void)
 {
-	parseJson(&processJsonPair, NULL);
-	
+	parseJson(&processJsonPair, NULL, &receivedJson);
+}
+
+void PiLink::receivedJson(void *data)
+{
+	applySettings();
+	eepromManager.commitTempSettings(); // one eeprom write for all settings in the message
 #if !BREWPI_SIMULATE
 	// This is a lot of overhead and not needed for the simulator	   
 	sendControlSettings(); // Update script with new settings
 	sendControlConstants();
 #endif
-	return;
 }
 
+#if BREWPI_CHAMBER_COUNT > 1
+// Settings and commands that follow apply to the selected chamber.
+void PiLink::setChamber(const char *val)
+{
+	applySettings(); // staged settings belong to the previous chamber
+	uint8_t chamber = atoi(val);
+	if (!chamber || !ChamberManager::selectChamber(chamber - 1))
+	{
+		logErrorInt(ERROR_INVALID_CHAMBER, chamber);
+	}
+}
+#endif
+
+// The mode and setpoints in a JSON message are staged, and applied together when the message is complete.
+// The controller then runs once with the final values and a single temperature line carries the annotations.
+enum
+{
+	STAGED_MODE = 1,
+	STAGED_BEER_SETTING = 2,
+	STAGED_FRIDGE_SETTING = 4
+};
+
+static struct
+{
+	uint8_t staged; // STAGED_* flags
+	char mode;
+	temperature beerSetting;
+	temperature fridgeSetting;
+} pendingSettings;
+
 void PiLink::setMode(const char *val)
 {
-	char mode = val[0];
-	tempControl.setMode(mode);
-	piLink.printFridgeAnnotation(STR_FMT_SET_TO, STR_MODE, val, STR_WEB_INTERFACE);
+	pendingSettings.mode = val[0];
+	pendingSettings.staged |= STAGED_MODE;
 }
 
 void PiLink::setBeerSetting(const char *val)
 {
-	const char *source = NULL;
-	temperature newTemp;
-	if (!stringToTemp(&newTemp, val))
+	if (stringToTemp(&pendingSettings.beerSetting, val))
 	{
-		return; // could not parse value
+		pendingSettings.staged |= STAGED_BEER_SETTING;
 	}
-	if (tempControl.cs.mode == 'p')
+}
+
+void PiLink::setFridgeSetting(const char *val)
+{
+	if (stringToTemp(&pendingSettings.fridgeSetting, val))
 	{
-		if (abs(newTemp - tempControl.cs.beerSetting) > 100)
-		{ // This excludes gradual updates under 0.2 degrees
-			source = STR_TEMPERATURE_PROFILE;
-		}
+		pendingSettings.staged |= STAGED_FRIDGE_SETTING;
 	}
-	else
+}
+
+static void formatAnnotation(char *annotation, const char *name, const char *val, const char *source)
+{
+	snprintf_P(annotation, 32, STR_FMT_SET_TO, name, val, source);
+}
+
+// Applies the staged mode and setpoints to the selected chamber
+void PiLink::applySettings(void)
+{
+	uint8_t staged = pendingSettings.staged;
+	if (!staged)
 	{
-		source = STR_WEB_INTERFACE;
+		return;
 	}
-	if (source)
+	pendingSettings.staged = 0;
+
+	char beerAnnotation[32];
+	char fridgeAnnotation[32];
+	char val[12];
+	beerAnnotation[0] = 0;
+	fridgeAnnotation[0] = 0;
+
+	if (staged & STAGED_MODE)
 	{
-		printBeerAnnotation(STR_FMT_SET_TO, STR_BEER_TEMP, val, source);
+		tempControl.setMode(pendingSettings.mode);
+		val[0] = pendingSettings.mode;
+		val[1] = 0;
+		formatAnnotation(fridgeAnnotation, STR_MODE, val, STR_WEB_INTERFACE);
 	}
-	tempControl.setBeerTemp(newTemp);
-}
-
-void PiLink::setFridgeSetting(const char *val)
-{
-	temperature newTemp;
-	if (!stringToTemp(&newTemp, val))
+	if (!(staged & STAGED_MODE) || tempControl.cs.mode != MODE_OFF)
 	{
-		return; // Could not parse value
+		// switching off disables the setpoints, whatever the order of the keys in the message
+		if (staged & STAGED_BEER_SETTING)
+		{
+			temperature newTemp = pendingSettings.beerSetting;
+			const char *source = STR_WEB_INTERFACE;
+			if (tempControl.cs.mode == 'p')
+			{
+				// This excludes gradual updates under 0.2 degrees
+				source = (abs(newTemp - tempControl.cs.beerSetting) > 100) ? STR_TEMPERATURE_PROFILE : NULL;
+			}
+			if (source)
+			{
+				formatAnnotation(beerAnnotation, STR_BEER_TEMP, tempToString(val, newTemp, 1, sizeof(val)), source);
+			}
+			tempControl.changeBeerSetting(newTemp);
+		}
+		if (staged & STAGED_FRIDGE_SETTING)
+		{
+			if (tempControl.cs.mode == 'f' && !fridgeAnnotation[0])
+			{
+				formatAnnotation(fridgeAnnotation, STR_FRIDGE_TEMP, tempToString(val, pendingSettings.fridgeSetting, 1, sizeof(val)), STR_WEB_INTERFACE);
+			}
+			tempControl.changeFridgeSetting(pendingSettings.fridgeSetting);
+		}
 	}
-	if (tempControl.cs.mode == 'f')
+	tempControl.updatePID();
+	tempControl.updateState();
+	if (beerAnnotation[0] || fridgeAnnotation[0])
 	{
-		printFridgeAnnotation(STR_FMT_SET_TO, STR_FRIDGE_TEMP, val, STR_WEB_INTERFACE);
+		printTemperaturesJSON(beerAnnotation[0] ? beerAnnotation : NULL, fridgeAnnotation[0] ? fridgeAnnotation : NULL);
 	}
-	tempControl.setFridgeTemp(newTemp);
 }
 
 void PiLink::setFanDuty(const char *val)
@@ -950,57 +1708,116 @@ void setBool(const char *value, uint8_t *target)
 		jsonKey, target, (JsonParserHandlerFn)&fn \
 	}
 
+// Sorted by key string in strcmp order (upper case first), so processJsonPair can use a binary search.
 const PiLink::JsonParserConvert PiLink::jsonParserConverters[] PROGMEM = {
-	JSON_CONVERT(JSONKEY_mode, NULL, setMode),
+	JSON_CONVERT(JSONKEY_Kd, &tempControl.cc.Kd, setStringToFixedPoint),
+	JSON_CONVERT(JSONKEY_Ki, &tempControl.cc.Ki, setStringToFixedPoint),
+	JSON_CONVERT(JSONKEY_Kp, &tempControl.cc.Kp, setStringToFixedPoint),
+	JSON_CONVERT(JSONKEY_beerFastFilter, MAKE_FILTER_SETTING_TARGET(FAST, BEER), applyFilterSetting),
 	JSON_CONVERT(JSONKEY_beerSetting, NULL, setBeerSetting),
-	JSON_CONVERT(JSONKEY_fridgeSetting, NULL, setFridgeSetting),
+	JSON_CONVERT(JSONKEY_beerSlopeFilter, MAKE_FILTER_SETTING_TARGET(SLOPE, BEER), applyFilterSetting),
+	JSON_CONVERT(JSONKEY_beerSlowFilter, MAKE_FILTER_SETTING_TARGET(SLOW, BEER), applyFilterSetting),
+#if BREWPI_CHAMBER_COUNT > 1
+	JSON_CONVERT(JSONKEY_chamber, NULL, setChamber),
+#endif
+	JSON_CONVERT(JSONKEY_coolEstimator, &tempControl.cs.coolEstimator, setStringToFixedPoint),
+	JSON_CONVERT(JSONKEY_coolingTargetUpper, &tempControl.cc.coolingTargetUpper, setStringToTempDiff),
+	JSON_CONVERT(JSONKEY_coolingTargetLower, &tempControl.cc.coolingTargetLower, setStringToTempDiff),
 	JSON_CONVERT(JSONKEY_fanDuty, NULL, setFanDuty),
-
+	JSON_CONVERT(JSONKEY_fridgeFastFilter, MAKE_FILTER_SETTING_TARGET(FAST, FRIDGE), applyFilterSetting),
+	JSON_CONVERT(JSONKEY_fridgeSetting, NULL, setFridgeSetting),
+	JSON_CONVERT(JSONKEY_fridgeSlopeFilter, MAKE_FILTER_SETTING_TARGET(SLOPE, FRIDGE), applyFilterSetting),
+	JSON_CONVERT(JSONKEY_fridgeSlowFilter, MAKE_FILTER_SETTING_TARGET(SLOW, FRIDGE), applyFilterSetting),
 	JSON_CONVERT(JSONKEY_heatEstimator, &tempControl.cs.heatEstimator, setStringToFixedPoint),
-	JSON_CONVERT(JSONKEY_coolEstimator, &tempControl.cs.coolEstimator, setStringToFixedPoint),
-
-	JSON_CONVERT(JSONKEY_tempFormat, NULL, setTempFormat),
-
-	JSON_CONVERT(JSONKEY_tempSettingMin, &tempControl.cc.tempSettingMin, setStringToTemp),
-	JSON_CONVERT(JSONKEY_tempSettingMax, &tempControl.cc.tempSettingMax, setStringToTemp),
-	JSON_CONVERT(JSONKEY_pidMax, &tempControl.cc.pidMax, setStringToTempDiff),
-
-	JSON_CONVERT(JSONKEY_Kp, &tempControl.cc.Kp, setStringToFixedPoint),
-	JSON_CONVERT(JSONKEY_Ki, &tempControl.cc.Ki, setStringToFixedPoint),
-	JSON_CONVERT(JSONKEY_Kd, &tempControl.cc.Kd, setStringToFixedPoint),
-
+	JSON_CONVERT(JSONKEY_heatingTargetUpper, &tempControl.cc.heatingTargetUpper, setStringToTempDiff),
+	JSON_CONVERT(JSONKEY_heatingTargetLower, &tempControl.cc.heatingTargetLower, setStringToTempDiff),
+	JSON_CONVERT(JSONKEY_rotaryHalfSteps, &tempControl.cc.rotaryHalfSteps, setBool),
 	JSON_CONVERT(JSONKEY_iMaxError, &tempControl.cc.iMaxError, setStringToTempDiff),
 	JSON_CONVERT(JSONKEY_idleRangeHigh, &tempControl.cc.idleRangeHigh, setStringToTempDiff),
 	JSON_CONVERT(JSONKEY_idleRangeLow, &tempControl.cc.idleRangeLow, setStringToTempDiff),
-	JSON_CONVERT(JSONKEY_heatingTargetUpper, &tempControl.cc.heatingTargetUpper, setStringToTempDiff),
-	JSON_CONVERT(JSONKEY_heatingTargetLower, &tempControl.cc.heatingTargetLower, setStringToTempDiff),
-	JSON_CONVERT(JSONKEY_coolingTargetUpper, &tempControl.cc.coolingTargetUpper, setStringToTempDiff),
-	JSON_CONVERT(JSONKEY_coolingTargetLower, &tempControl.cc.coolingTargetLower, setStringToTempDiff),
-	JSON_CONVERT(JSONKEY_maxHeatTimeForEstimate, &tempControl.cc.maxHeatTimeForEstimate, setUint16),
-	JSON_CONVERT(JSONKEY_maxCoolTimeForEstimate, &tempControl.cc.maxCoolTimeForEstimate, setUint16),
 	JSON_CONVERT(JSONKEY_lightAsHeater, &tempControl.cc.lightAsHeater, setBool),
-	JSON_CONVERT(JSONKEY_rotaryHalfSteps, &tempControl.cc.rotaryHalfSteps, setBool),
+	JSON_CONVERT(JSONKEY_maxCoolTimeForEstimate, &tempControl.cc.maxCoolTimeForEstimate, setUint16),
+	JSON_CONVERT(JSONKEY_maxHeatTimeForEstimate, &tempControl.cc.maxHeatTimeForEstimate, setUint16),
+	JSON_CONVERT(JSONKEY_mode, NULL, setMode),
+	JSON_CONVERT(JSONKEY_pidMax, &tempControl.cc.pidMax, setStringToTempDiff),
+	JSON_CONVERT(JSONKEY_tempFormat, NULL, setTempFormat),
+	JSON_CONVERT(JSONKEY_tempSettingMax, &tempControl.cc.tempSettingMax, setStringToTemp),
+	JSON_CONVERT(JSONKEY_tempSettingMin, &tempControl.cc.tempSettingMin, setStringToTemp)};
 
-	JSON_CONVERT(JSONKEY_fridgeFastFilter, MAKE_FILTER_SETTING_TARGET(FAST, FRIDGE), applyFilterSetting),
-	JSON_CONVERT(JSONKEY_fridgeSlowFilter, MAKE_FILTER_SETTING_TARGET(SLOW, FRIDGE), applyFilterSetting),
-	JSON_CONVERT(JSONKEY_fridgeSlopeFilter, MAKE_FILTER_SETTING_TARGET(SLOPE, FRIDGE), applyFilterSetting),
-	JSON_CONVERT(JSONKEY_beerFastFilter, MAKE_FILTER_SETTING_TARGET(FAST, BEER), applyFilterSetting),
-	JSON_CONVERT(JSONKEY_beerSlowFilter, MAKE_FILTER_SETTING_TARGET(SLOW, BEER), applyFilterSetting),
-	JSON_CONVERT(JSONKEY_beerSlopeFilter, MAKE_FILTER_SETTING_TARGET(SLOPE, BEER), applyFilterSetting)};
+#if BREWPI_DEBUG > 0
+// Returns the index of the first key that is not greater than the key before it, or 0 if the table is sorted.
+static uint8_t findUnsortedJsonKey(const void *table, uint8_t count, uint8_t entrySize)
+{
+	const char *previous = NULL;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		const char *entryKey;
+		memcpy_P(&entryKey, (const uint8_t *)table + i * entrySize, sizeof(entryKey));
+		if (previous)
+		{
+			const char *a = previous;
+			const char *b = entryKey;
+			uint8_t ca, cb;
+			do
+			{
+				ca = pgm_read_byte(a++);
+				cb = pgm_read_byte(b++);
+			} while (ca && ca == cb);
+			if (ca >= cb)
+			{
+				return i;
+			}
+		}
+		previous = entryKey;
+	}
+	return 0;
+}
+#endif
+
+int8_t PiLink::findJsonKey(const char *key, const void *table, uint8_t count, uint8_t entrySize)
+{
+#if BREWPI_DEBUG > 0
+	uint8_t unsorted = findUnsortedJsonKey(table, count, entrySize);
+	if (unsorted)
+	{
+		logErrorInt(ERROR_JSON_KEYS_NOT_SORTED, unsorted);
+	}
+#endif
+	uint8_t low = 0;
+	uint8_t high = count;
+	while (low < high)
+	{
+		uint8_t mid = (low + high) / 2;
+		const char *entryKey;
+		memcpy_P(&entryKey, (const uint8_t *)table + mid * entrySize, sizeof(entryKey));
+		int cmp = strcmp_P(key, entryKey);
+		if (cmp == 0)
+		{
+			return mid;
+		}
+		if (cmp < 0)
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+	return -1;
+}
 
 void PiLink::processJsonPair(const char *key, const char *val, void *pv)
 {
 	logInfoStringString(INFO_RECEIVED_SETTING, key, val);
 
-	for (uint8_t i = 0; i < sizeof(jsonParserConverters) / sizeof(jsonParserConverters[0]); i++)
+	int8_t i = findJsonKey(key, jsonParserConverters, sizeof(jsonParserConverters) / sizeof(jsonParserConverters[0]), sizeof(JsonParserConvert));
+	if (i >= 0)
 	{
 		JsonParserConvert converter;
 		memcpy_P(&converter, &jsonParserConverters[i], sizeof(converter));
-		if (strcmp_P(key, converter.key) == 0)
-		{
-			converter.fn(val, converter.target);
-			return;
-		}
+		converter.fn(val, converter.target);
+		return;
 	}
 	logWarning(WARNING_COULD_NOT_PROCESS_SETTING);
 }
@@ -33,6 +33,7 @@ license and credits. */
 #include "TemperatureFormats.h"
 #include "DeviceManager.h"
 #include "Logger.h"
+#include "PiLinkTxQueue.h"
 
 #define PRINTF_BUFFER_SIZE 128
 
@@ -54,29 +55,87 @@ class PiLink
 
 	static void printTemperatures(void);
 
+	// Groups of values in the temperature line. The host subscribes to them with the 'u' command.
+	enum TelemetryGroups
+	{
+		TELEMETRY_TEMPS = 1,	 // beer, fridge and room temperatures and settings
+		TELEMETRY_STATE = 2,	 // control state
+		TELEMETRY_VARIABLES = 4, // control variables, pushed as a separate V: line
+		TELEMETRY_HUMIDITY = 8,  // fridge humidity
+		TELEMETRY_TIME = 0x40,   // add the time of the control tick
+		TELEMETRY_ALL = 0x3F
+	};
+
+#if BREWPI_TELEMETRY_PUSH
+	// Called at every control tick. Pushes the subscribed groups when the period elapsed and a value
+	// moved more than the deadband since the previous temperature line.
+	static void pushTelemetry(void);
+#endif
+
 	typedef void (*ParseJsonCallback)(const char *key, const char *val, void *data);
+	typedef void (*JsonCompleteCallback)(void *data);
+
+	// Starts parsing the JSON argument of a command. The object is parsed as it arrives in receive(),
+	// fn is called for each pair and complete after the closing brace. data must remain valid until then.
+	static void parseJson(ParseJsonCallback fn, void *data = NULL, JsonCompleteCallback complete = NULL);
+
+	// Returns the index of key in a PROGMEM table sorted by key (strcmp order), or -1 if not found.
+	// The first field of each entry must be a pointer to the PROGMEM key string. Debug builds log an error when the
+	// table is not sorted.
+	static int8_t findJsonKey(const char *key, const void *table, uint8_t count, uint8_t entrySize);
+
+#if BREWPI_COMPACT_TELEMETRY
+	// Send only changed values with short keys in the temperature line. Selected by the host with the 'm' command.
+	static bool compactTelemetry;
+#else
+	static const bool compactTelemetry = false;
+#endif
+
+#if BREWPI_BINARY_PILINK
+	// Send temperatures, settings, constants, variables and log messages as binary frames with a CRC.
+	// Selected by the host with the 'b' command.
+	static bool binaryMode;
 
-	static void parseJson(ParseJsonCallback fn, void *data = NULL);
+	static void beginFrame(char type, uint8_t length);
+	static void writeFrameBytes(const void *data, uint8_t length);
+	static void endFrame();
+#endif
 
   private:
 	static void sendControlSettings(void);
 	static void receiveControlConstants(void);
 	static void sendControlConstants(void);
 	static void sendControlVariables(void);
+	static void printControlSettings(void);
+	static void printDisplayLines(void);
+#if BREWPI_FULL_STATE_COMMAND
+	static void sendFullState(void);
+#endif
+	static void sendLoopProfile(void);
 
 	static void receiveJson(void); // receive settings as JSON key:value pairs
+	static void receivedJson(void *data);
+
+	static bool parsingJson(void);
+	static void parseJsonChar(char c);
+	static void completeJson(void);
 
 	static void print(char *fmt, ...); // use when format string is stored in RAM
 	static void print(char c)		   // inline for arduino
 #ifdef ARDUINO
 	{
+#if PILINK_TX_QUEUE_SIZE
+		PiLinkTxQueue::put(c);
+#else
 		Serial.print(c);
+#endif
 	}
 #else
 		;
 #endif
 
 	static void print_P(const char *fmt, ...); // use when format string is stored in PROGMEM with PSTR("string")
+	static void printQuoted(const char *s);	// prints a string from RAM between double quotes, without printf
 	static void printNewLine(void);
 	static void printChamberCount();
 
@@ -85,7 +144,8 @@ class PiLink
 	static void printResponse(char responseChar);
 	static void printChamberInfo();
 
-	static void printTemperaturesJSON(char *beerAnnotation, char *fridgeAnnotation);
+	static void printTemperaturesJSON(char *beerAnnotation, char *fridgeAnnotation, uint8_t groups = TELEMETRY_ALL);
+	static void printTemperaturePairs(char *beerAnnotation, char *fridgeAnnotation, uint8_t groups);
 	static void sendJsonPair(const char *name, const char *val); // send one JSON pair with a string value as name:val,
 	static void sendJsonPair(const char *name, char val);		 // send one JSON pair with a char value as name:val,
 	static void sendJsonPair(const char *name, uint16_t val);	// send one JSON pair with a uint16_t value as name:val,
@@ -95,11 +155,36 @@ class PiLink
 	static void sendJsonHumidity(const char *name, humidity hum);
 
 	static void processJsonPair(const char *key, const char *val, void *pv); // process one pair
+#if BREWPI_BINARY_PILINK
+	static void setBinaryMode(const char *key, const char *val, void *data);
+	static void sendBinaryMode(void *data);
+	static void sendFrame(char type, const void *payload, uint8_t length);
+	static void sendTemperaturesFrame(const char *beerAnnotation, const char *fridgeAnnotation);
+	static void sendLogFrame(char type, uint8_t errorID, const char *varTypes, va_list args);
+	static uint16_t frameCrc;
+#endif
+#if BREWPI_TEMP_HISTORY
+	static void setHistoryStart(const char *key, const char *val, void *data);
+	static void sendHistory(void *data);
+	static void printHistorySample(uint16_t sequence, const temperature *temps, uint8_t state);
+#endif
+#if BREWPI_COMPACT_TELEMETRY
+	static void setTelemetryFormat(const char *key, const char *val, void *data);
+	static void sendTelemetryFormat(void *data);
+#endif
+#if BREWPI_TELEMETRY_PUSH
+	static void setTelemetrySubscription(const char *key, const char *val, void *data);
+	static void sendTelemetrySubscription(void *data);
+#endif
 
 	/* Prints the name part of a json name/value pair. The name must exist in PROGMEM */
 	static void printJsonName(const char *name);
 	static void printJsonSeparator();
 	static void sendJsonClose();
+#if BREWPI_FULL_STATE_COMMAND
+	static void openJsonObject(const char *name);
+	static void closeJsonObject(void);
+#endif
 
 	static void openListResponse(char type);
 	static void closeListResponse();
@@ -112,6 +197,7 @@ class PiLink
 	};
 	typedef void (*JsonOutputHandler)(const char *key, uint8_t offset);
 	static void sendJsonValues(char responseType, const JsonOutput * /*PROGMEM*/ jsonOutputMap, uint8_t mapCount);
+	static void printJsonValues(const JsonOutput * /*PROGMEM*/ jsonOutputMap, uint8_t mapCount);
 
 	// handler functions for JSON output
 	static void jsonOutputUint8(const char *key, uint8_t offset);
@@ -126,11 +212,15 @@ class PiLink
 
 	// Json parsing
 
+#if BREWPI_CHAMBER_COUNT > 1
+	static void setChamber(const char *val);
+#endif
 	static void setMode(const char *val);
 	static void setBeerSetting(const char *val);
 	static void setFridgeSetting(const char *val);
 	static void setFanDuty(const char *val);
 	static void setTempFormat(const char *val);
+	static void applySettings(void);
 
 	typedef void (*JsonParserHandlerFn)(const char *val, void *target);
 
@@ -0,0 +1,118 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "PiLinkTxQueue.h"
+
+#if PILINK_TX_QUEUE_SIZE
+
+PiLinkTxQueue piLinkTxQueue;
+
+uint32_t PiLinkTxQueue::bytesQueued;
+uint32_t PiLinkTxQueue::bytesDropped;
+uint16_t PiLinkTxQueue::peakDepth;
+uint8_t PiLinkTxQueue::buffer[PILINK_TX_QUEUE_SIZE];
+uint16_t PiLinkTxQueue::head;
+uint16_t PiLinkTxQueue::count;
+uint16_t PiLinkTxQueue::messageBytes;
+bool PiLinkTxQueue::lowPriority;
+bool PiLinkTxQueue::dropping;
+
+void PiLinkTxQueue::beginMessage(bool low)
+{
+	lowPriority = low;
+	dropping = false;
+	messageBytes = 0;
+}
+
+void PiLinkTxQueue::endMessage()
+{
+	beginMessage(false); // bytes outside a message are not dropped
+}
+
+void PiLinkTxQueue::put(uint8_t b)
+{
+	if (dropping)
+	{
+		bytesDropped++;
+		return;
+	}
+	if (lowPriority)
+	{
+		if (count >= PILINK_TX_QUEUE_SIZE - PILINK_TX_QUEUE_RESERVE)
+		{
+			// Take the part of the message that is already queued out again. Nothing of it was sent,
+			// because the queue is only drained between messages.
+			head = (head + PILINK_TX_QUEUE_SIZE - messageBytes) % PILINK_TX_QUEUE_SIZE;
+			count -= messageBytes;
+			bytesQueued -= messageBytes;
+			bytesDropped += messageBytes + 1;
+			dropping = true;
+			return;
+		}
+		messageBytes++;
+	}
+	else
+	{
+		while (count == PILINK_TX_QUEUE_SIZE)
+		{
+			sendOne(true);
+		}
+	}
+	buffer[head] = b;
+	head = (head + 1) % PILINK_TX_QUEUE_SIZE;
+	count++;
+	bytesQueued++;
+	if (count > peakDepth)
+	{
+		peakDepth = count;
+	}
+}
+
+// Sends the oldest byte. Returns false when the serial port has no room and wait is false.
+bool PiLinkTxQueue::sendOne(bool wait)
+{
+	if (!wait && Serial.availableForWrite() <= 0)
+	{
+		return false;
+	}
+	uint16_t tail = (head + PILINK_TX_QUEUE_SIZE - count) % PILINK_TX_QUEUE_SIZE;
+	Serial.write(buffer[tail]);
+	count--;
+	return true;
+}
+
+void PiLinkTxQueue::drain()
+{
+	while (count && sendOne(false))
+	{
+	}
+}
+
+#endif
@@ -0,0 +1,116 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "Platform.h"
+
+#if PILINK_TX_QUEUE_SIZE
+
+/* Queue between PiLink and the serial port, so printing a response does not wait until the bytes are sent.
+ *
+ * PiLink writes to the queue instead of Serial. drain() moves bytes to the serial port as far as its hardware
+ * buffer has room, without blocking; PiLink::receive() calls it every few milliseconds.
+ *
+ * Each response is a message, from printResponse() (or the start of a binary frame) to the end of the line
+ * (or frame). Log messages are low priority: they may only use the queue up to PILINK_TX_QUEUE_RESERVE bytes
+ * below full. A log message that does not fit is taken out of the queue again and dropped as a whole. Other
+ * messages are never dropped: when the queue is full, they wait for the serial port as before.
+ */
+class PiLinkTxQueue : public Stream
+{
+  public:
+	void begin(unsigned long baud)
+	{
+		Serial.begin(baud);
+	}
+	int available()
+	{
+		return Serial.available();
+	}
+	int read()
+	{
+		return Serial.read();
+	}
+	int peek()
+	{
+		return Serial.peek();
+	}
+	void flush()
+	{
+		while (count)
+		{
+			sendOne(true);
+		}
+	}
+	size_t write(uint8_t b)
+	{
+		put(b);
+		return 1;
+	}
+	size_t println()
+	{
+		put('\r');
+		put('\n');
+		endMessage();
+		return 2;
+	}
+	operator bool()
+	{
+		return true;
+	}
+
+	static void put(uint8_t b);
+	static void beginMessage(bool lowPriority);
+	static void endMessage();
+	static void drain();
+	static bool isEmpty()
+	{
+		return count == 0;
+	}
+
+	static uint32_t bytesQueued;  // bytes accepted in the queue
+	static uint32_t bytesDropped; // bytes of log messages dropped because the queue was full
+	static uint16_t peakDepth;	// highest number of bytes waiting in the queue
+
+  private:
+	static bool sendOne(bool wait);
+
+	static uint8_t buffer[PILINK_TX_QUEUE_SIZE];
+	static uint16_t head;		  // next free position
+	static uint16_t count;		  // bytes waiting
+	static uint16_t messageBytes; // bytes of the current low priority message in the queue
+	static bool lowPriority;
+	static bool dropping; // the rest of the current message is dropped
+};
+
+extern PiLinkTxQueue piLinkTxQueue;
+
+#endif
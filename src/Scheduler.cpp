@@ -0,0 +1,103 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "Scheduler.h"
+
+void Scheduler::start(const ScheduledTask * /*PROGMEM*/ tasks, TaskStats *stats, uint8_t count)
+{
+	ticks_millis_t now = ticks.millis();
+	for (uint8_t i = 0; i < count; i++)
+	{
+		stats[i].release = now + pgm_read_word(&tasks[i].phase);
+		stats[i].overruns = 0;
+		stats[i].maxLateness = 0;
+	}
+}
+
+void Scheduler::resetStats(TaskStats *stats, uint8_t count)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		stats[i].overruns = 0;
+		stats[i].maxLateness = 0;
+	}
+}
+
+bool Scheduler::run(const ScheduledTask * /*PROGMEM*/ tasks, TaskStats *stats, uint8_t count)
+{
+	ticks_millis_t now = ticks.millis();
+	uint8_t next = count;
+	ticks_millis_t nextDeadline = 0;
+
+	// find the released task with the earliest absolute deadline
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (int32_t(now - stats[i].release) < 0)
+		{
+			continue; // not released yet
+		}
+		ticks_millis_t deadline = stats[i].release + pgm_read_word(&tasks[i].deadline);
+		if (next == count || int32_t(deadline - nextDeadline) < 0)
+		{
+			next = i;
+			nextDeadline = deadline;
+		}
+	}
+	if (next == count)
+	{
+		return false;
+	}
+
+	ScheduledTask task;
+	memcpy_P(&task, &tasks[next], sizeof(task));
+	TaskStats &s = stats[next];
+
+	ticks_millis_t lateness = now - s.release;
+	if (lateness > task.deadline)
+	{
+		s.overruns++;
+	}
+	if (lateness > s.maxLateness)
+	{
+		s.maxLateness = (lateness > UINT16_MAX) ? UINT16_MAX : lateness;
+	}
+
+	// Keep the phase of the task. Releases that have been missed entirely
+	// are skipped and counted as overruns, instead of running in a burst.
+	s.release += task.period;
+	while (int32_t(now - s.release) >= int32_t(task.period))
+	{
+		s.release += task.period;
+		s.overruns++;
+	}
+
+	task.run();
+	return true;
+}
@@ -0,0 +1,85 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "Ticks.h"
+
+/*
+ * A small cooperative scheduler. Each task is released periodically and
+ * must be started before its deadline expires. Of all released tasks, the
+ * one with the earliest absolute deadline runs first (EDF), and only one
+ * task runs per call to run(). This gives short tasks like serial polling
+ * a chance to run in between slow tasks like LCD and OneWire updates.
+ *
+ * The task table is stored in PROGMEM. Per task runtime data is kept in a
+ * separate TaskStats array of the same length, provided by the caller.
+ */
+
+typedef void (*TaskFn)(void);
+
+struct ScheduledTask
+{
+	TaskFn run;		   // function to call when the task is released
+	uint16_t period;   // time between releases in milliseconds
+	uint16_t phase;	   // offset of the first release in milliseconds
+	uint16_t deadline; // maximum start latency after release in milliseconds
+};
+
+struct TaskStats
+{
+	ticks_millis_t release; // time of the current (or next) release
+	uint16_t overruns;		// number of releases started after their deadline or skipped
+	uint16_t maxLateness;	// worst observed start latency after release in milliseconds
+};
+
+class Scheduler
+{
+  public:
+	/**
+	 * Resets the statistics and schedules the first release of each task at now + phase.
+	 */
+	static void start(const ScheduledTask * /*PROGMEM*/ tasks, TaskStats *stats, uint8_t count);
+
+	/**
+	 * Runs the released task with the earliest deadline, if any.
+	 * Returns true if a task was run.
+	 */
+	static bool run(const ScheduledTask * /*PROGMEM*/ tasks, TaskStats *stats, uint8_t count);
+
+	/**
+	 * Clears the overrun counts and worst latenesses, without changing the releases.
+	 */
+	static void resetStats(TaskStats *stats, uint8_t count);
+};
+
+// Statistics of the tasks of the control loop in Brewpi.cpp, sent with the 'p' command
+extern TaskStats brewpiTaskStats[];
+extern const uint8_t brewpiTaskCount;
@@ -30,6 +30,7 @@ license and credits. */
 #include "Brewpi.h"
 #include "SettingsManager.h"
 #include "TempControl.h"
+#include "ChamberManager.h"
 #include "FanControl.h"
 #include "PiLink.h"
 #include "TempSensorExternal.h"
@@ -40,8 +41,8 @@ void SettingsManager::loadSettings()
 
 	if (!eepromManager.applySettings())
 	{
-		tempControl.loadDefaultSettings();
-		tempControl.loadDefaultConstants();
+		FOR_EACH_CHAMBER(loadDefaultSettings);
+		FOR_EACH_CHAMBER(loadDefaultConstants);
 
 		deviceManager.setupUnconfiguredDevices();
 
@@ -32,6 +32,10 @@ license and credits. */
 
 #include "Display.h"
 #include "PiLink.h"
+#include "EepromManager.h"
+#include "UI.h"
+#include "LoopProfiler.h"
+#include "TempHistory.h"
 
 #if BREWPI_SIMULATE
 
@@ -88,11 +92,18 @@ void simulateLoop(void)
     { //update settings every second
         lastUpdate = ticks.millis();
 
-        tempControl.updateTemperatures();
-        tempControl.detectPeaks();
-        tempControl.updatePID();
-        tempControl.updateState();
-        tempControl.updateOutputs();
+        PROFILE_STAGE(PROFILE_UPDATE_TEMPERATURES, tempControl.updateTemperatures());
+        PROFILE_STAGE(PROFILE_DETECT_PEAKS, tempControl.detectPeaks());
+        PROFILE_STAGE(PROFILE_UPDATE_PID, tempControl.updatePID());
+        PROFILE_STAGE(PROFILE_UPDATE_STATE, tempControl.updateState());
+        PROFILE_STAGE(PROFILE_UPDATE_OUTPUTS, tempControl.updateOutputs());
+        eepromManager.commitTempSettingsWhenQuiet();
+#if BREWPI_TEMP_HISTORY
+        TempHistory::update();
+#endif
+#if BREWPI_TELEMETRY_PUSH
+        piLink.pushTelemetry();
+#endif
 
 #if !BREWPI_EMULATE // simulation on actual hardware
         static uint8_t updateCount = 0;
@@ -106,9 +117,7 @@ void simulateLoop(void)
 #endif
         {
             // update the lcd for the chamber being displayed
-            display.printState();
-            display.printAllTemperatures();
-            display.printMode();
+            PROFILE_STAGE(PROFILE_UI_UPDATE, ui.update());
             display.updateBacklight();
         }
 
@@ -119,7 +128,7 @@ void simulateLoop(void)
     if ((::millis() - lastCheckSerial) >= 1000 && (lastCheckSerial = ::millis() > 0)) // only listen if 1s passed since last time
 #endif
         //listen for incoming serial connections while waiting to update
-        piLink.receive();
+        PROFILE_STAGE(PROFILE_PILINK_RECEIVE, piLink.receive());
 }
 
 #include "TempSensorExternal.h"
@@ -141,6 +150,8 @@ const char SimulatorCoeffRoom[] PROGMEM = "ke";
 const char SimulatorRoomTempMin[] PROGMEM = "rmi";
 const char SimulatorRoomTempMax[] PROGMEM = "rmx";
 const char SimulatorBeerDensity[] PROGMEM = "sg";
+const char SimulatorSetTicks[] PROGMEM = "s";
+const char SimulatorRunFactor[] PROGMEM = "r";
 const char SimulatorTime[] PROGMEM = "t";
 
 void setTicks(ExternalTicks &externalTicks, const char *val, int multiplier = 1000)
@@ -168,85 +179,66 @@ void setTicks(ExternalTicks &externalTicks, const char *val, int multiplier = 10
  */
 extern uint8_t printTempInterval;
 
+static bool isOn(const char *val) { return strcmp(val, "0") != 0; }
+
+// this set the system timer, but not the simulator counter
+static void setSimulatorTicks(const char *val) { setTicks(ticks, val, 1000); }
+static void setRoomTempMin(const char *val) { simulator.setMinRoomTemp(atof(val)); }
+static void setRoomTempMax(const char *val) { simulator.setMaxRoomTemp(atof(val)); }
+static void setFridgeVolume(const char *val) { simulator.setFridgeVolume(atof(val)); }
+static void setBeerVolume(const char *val) { simulator.setBeerVolume(atof(val)); }
+static void setBeerDensity(const char *val) { simulator.setBeerDensity(atof(val)); }
+static void setFridgeTemp(const char *val) { simulator.setFridgeTemp(atof(val)); }
+static void setBeerTemp(const char *val) { simulator.setBeerTemp(atof(val)); }
+static void setHeatPower(const char *val) { simulator.setHeatPower(atof(val)); }
+static void setCoolPower(const char *val) { simulator.setCoolPower(atof(val)); }
+static void setCoeffRoom(const char *val) { simulator.setRoomCoefficient(atof(val)); }
+static void setCoeffBeer(const char *val) { simulator.setBeerCoefficient(atof(val)); }
+static void setBeerConnected(const char *val) { simulator.setConnected(tempControl.beerSensor, isOn(val)); }
+static void setFridgeConnected(const char *val) { simulator.setConnected(tempControl.fridgeSensor, isOn(val)); }
+static void setDoorState(const char *val) { simulator.setSwitch(tempControl.door, isOn(val)); } // 0 for closed, anything else for open
+static void setSimulatorRunFactor(const char *val) { setRunFactor(stringToFixedPoint(val)); }
+static void setPrintInterval(const char *val) { printTempInterval = atol(val); }
+static void setNoise(const char *val) { simulator.setSensorNoise(atof(val)); }
+static void setEnabled(const char *val) { simulator.setSimulationEnabled(isOn(val)); }
+
+struct SimulatorConfigKey
+{
+    const char * /*PROGMEM*/ key;
+    void (*fn)(const char *val);
+};
+
+// Sorted by key string, for PiLink::findJsonKey
+static const SimulatorConfigKey simulatorConfigKeys[] PROGMEM = {
+    {SimulatorBeerTemp, setBeerTemp},
+    {SimulatorBeerConnected, setBeerConnected},
+    {SimulatorBeerVolume, setBeerVolume},
+    {SimulatorCoolPower, setCoolPower},
+    {SimulatorDoorState, setDoorState},
+    {SimulatorEnabled, setEnabled},
+    {SimulatorFridgeTemp, setFridgeTemp},
+    {SimulatorFridgeConnected, setFridgeConnected},
+    {SimulatorFridgeVolume, setFridgeVolume},
+    {SimulatorHeatPower, setHeatPower},
+    {SimulatorPrintInterval, setPrintInterval},
+    {SimulatorCoeffBeer, setCoeffBeer},
+    {SimulatorCoeffRoom, setCoeffRoom},
+    {SimulatorNoise, setNoise},
+    {SimulatorRunFactor, setSimulatorRunFactor},
+    {SimulatorRoomTempMin, setRoomTempMin},
+    {SimulatorRoomTempMax, setRoomTempMax},
+    {SimulatorSetTicks, setSimulatorTicks},
+    {SimulatorBeerDensity, setBeerDensity},
+};
+
 void HandleSimulatorConfig(const char *key, const char *val, void *pv)
 {
-    // this set the system timer, but not the simulator counter
-    if (strcmp_P(key, PSTR("s")) == 0)
-    {
-        setTicks(ticks, val, 1000);
-    }
-    // these are all doubles - could replace this with a map of string keys to methods
-    else if (strcmp_P(key, SimulatorRoomTempMin) == 0)
-    {
-        simulator.setMinRoomTemp(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorRoomTempMax) == 0)
-    {
-        simulator.setMaxRoomTemp(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorFridgeVolume) == 0)
-    {
-        simulator.setFridgeVolume(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorBeerVolume) == 0)
-    {
-        simulator.setBeerVolume(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorBeerDensity) == 0)
-    {
-        simulator.setBeerDensity(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorFridgeTemp) == 0)
-    {
-        simulator.setFridgeTemp(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorBeerTemp) == 0)
-    {
-        simulator.setBeerTemp(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorHeatPower) == 0)
-    {
-        simulator.setHeatPower(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorCoolPower) == 0)
-    {
-        simulator.setCoolPower(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorCoeffRoom) == 0)
+    int8_t i = PiLink::findJsonKey(key, simulatorConfigKeys, sizeof(simulatorConfigKeys) / sizeof(simulatorConfigKeys[0]), sizeof(SimulatorConfigKey));
+    if (i >= 0)
     {
-        simulator.setRoomCoefficient(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorCoeffBeer) == 0)
-    {
-        simulator.setBeerCoefficient(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorBeerConnected) == 0)
-    {
-        simulator.setConnected(tempControl.beerSensor, strcmp(val, "0") != 0);
-    }
-    else if (strcmp_P(key, SimulatorFridgeConnected) == 0)
-    {
-        simulator.setConnected(tempControl.fridgeSensor, strcmp(val, "0") != 0);
-    }
-    else if (strcmp_P(key, SimulatorDoorState) == 0)
-    { // 0 for closed, anything else for open
-        simulator.setSwitch(tempControl.door, strcmp(val, "0") != 0);
-    }
-    else if (strcmp_P(key, PSTR("r")) == 0)
-    {
-        setRunFactor(stringToFixedPoint(val));
-    }
-    else if (!strcmp_P(key, SimulatorPrintInterval))
-    {
-        printTempInterval = atol(val);
-    }
-    else if (!strcmp_P(key, SimulatorNoise))
-    {
-        simulator.setSensorNoise(atof(val));
-    }
-    else if (strcmp_P(key, SimulatorEnabled) == 0)
-    { // 0 for closed, anything else for open
-        simulator.setSimulationEnabled(strcmp(val, "0") != 0);
+        void (*fn)(const char *val);
+        memcpy_P(&fn, &simulatorConfigKeys[i].fn, sizeof(fn));
+        fn(val);
     }
 }
 
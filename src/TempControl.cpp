@@ -75,6 +75,7 @@ states TempControl::state;
 bool TempControl::doPosPeakDetect;
 bool TempControl::doNegPeakDetect;
 bool TempControl::doorOpen;
+uint8_t TempControl::integralUpdateCounter;
 
 // keep track of beer setting stored in EEPROM
 temperature TempControl::storedBeerSetting;
@@ -156,7 +157,6 @@ void TempControl::updateTemperatures(void)
 
 void TempControl::updatePID(void)
 {
-	static unsigned char integralUpdateCounter = 0;
 	if (tempControl.modeIsBeer())
 	{
 		if (isDisabledOrInvalid(cs.beerSetting))
@@ -218,24 +218,26 @@ void TempControl::updatePID(void)
 				// decrease integral by 1/8 when far from the end value to reset the integrator
 				integratorUpdate = -(cv.diffIntegral >> 3);
 			}
-			cv.diffIntegral = cv.diffIntegral + integratorUpdate;
+			// saturate instead of wrapping around, a wrapped integral would flip the sign of its action
+			cv.diffIntegral = Fixed23_9::fromRaw(cv.diffIntegral).saturatingAdd(Fixed7_9::fromRaw(integratorUpdate).widen<23, 9>()).raw();
 		}
 
-		// calculate PID parts. Use long_temperature to prevent overflow
-		cv.p = multiplyFactorTemperatureDiff(cc.Kp, cv.beerDiff);
-		cv.i = multiplyFactorTemperatureDiffLong(cc.Ki, cv.diffIntegral);
-		cv.d = multiplyFactorTemperatureDiff(cc.Kd, cv.beerSlope);
-		long_temperature newFridgeSetting = cs.beerSetting;
-		newFridgeSetting += cv.p;
-		newFridgeSetting += cv.i;
-		newFridgeSetting += cv.d;
+		// calculate PID parts. Each part saturates to the temperature range, the sum is widened to prevent overflow
+		Fixed7_9 p = Fixed7_9::fromRaw(cc.Kp).saturatingMul(Fixed7_9::fromRaw(cv.beerDiff));
+		Fixed7_9 i = Fixed7_9::fromRaw(cc.Ki).saturatingMul(Fixed23_9::fromRaw(cv.diffIntegral));
+		Fixed7_9 d = Fixed7_9::fromRaw(cc.Kd).saturatingMul(Fixed7_9::fromRaw(cv.beerSlope));
+		cv.p = p.raw();
+		cv.i = i.raw();
+		cv.d = d.raw();
+		Fixed23_9 newFridgeSetting = Fixed7_9::fromRaw(cs.beerSetting).widen<23, 9>() + p.widen<23, 9>() + i.widen<23, 9>() + d.widen<23, 9>();
 
 		// constrain to tempSettingMin or beerSetting - pidMAx, whichever is lower.
 		temperature lowerBound = (cs.beerSetting <= cc.tempSettingMin + cc.pidMax) ? cc.tempSettingMin : cs.beerSetting - cc.pidMax;
 		// constrain to tempSettingMax or beerSetting + pidMAx, whichever is higher.
 		temperature upperBound = (cs.beerSetting >= cc.tempSettingMax - cc.pidMax) ? cc.tempSettingMax : cs.beerSetting + cc.pidMax;
 
-		cs.fridgeSetting = constrain(constrainTemp16(newFridgeSetting), lowerBound, upperBound);
+		temperature saturated = newFridgeSetting.saturate<7, 9>().raw();
+		cs.fridgeSetting = constrain(saturated, lowerBound, upperBound);
 	}
 	else if (cs.mode == MODE_FRIDGE_CONSTANT)
 	{
@@ -557,6 +559,9 @@ void TempControl::detectPeaks(void)
 	{
 		// send out log message for type of peak detected
 		logInfoTempTempFixedFixed(detected, peak, estimate, oldEstimator, newEstimator);
+#if TEMP_SENSOR_PEAK_DETECTOR
+		logInfoIntInt(INFO_PEAK_DETECTOR_STATS, fridgeSensor->peaks().acceptedCount(), fridgeSensor->peaks().rejectedCount());
+#endif
 	}
 }
 
@@ -719,6 +724,13 @@ humidity TempControl::getFridgeHumidity(void)
 }
 
 void TempControl::setBeerTemp(temperature newTemp)
+{
+	changeBeerSetting(newTemp);
+	updatePID();
+	updateState();
+}
+
+void TempControl::changeBeerSetting(temperature newTemp)
 {
 	temperature oldBeerSetting = cs.beerSetting;
 	cs.beerSetting = newTemp;
@@ -726,8 +738,6 @@ void TempControl::setBeerTemp(temperature newTemp)
 	{			 // more than half degree C difference with old setting
 		reset(); // reset controller
 	}
-	updatePID();
-	updateState();
 	if (cs.mode != MODE_BEER_PROFILE || abs(storedBeerSetting - newTemp) > intToTempDiff(1) / 4)
 	{
 		// more than 1/4 degree C difference with EEPROM
@@ -740,10 +750,15 @@ void TempControl::setBeerTemp(temperature newTemp)
 
 void TempControl::setFridgeTemp(temperature newTemp)
 {
-	cs.fridgeSetting = newTemp;
-	reset(); // reset peak detection and PID
+	changeFridgeSetting(newTemp);
 	updatePID();
 	updateState();
+}
+
+void TempControl::changeFridgeSetting(temperature newTemp)
+{
+	cs.fridgeSetting = newTemp;
+	reset(); // reset peak detection and PID
 	eepromManager.storeTempSettings();
 }
 
@@ -790,6 +805,7 @@ const ControlConstants TempControl::ccDefaults PROGMEM =
 
 		// Set filter coefficients. This is the b value. See FilterFixed.h for delay times.
 		// The delay time is 3.33 * 2^b * number of cascades
+		// A slope filter value of 8 or more uses a least squares fit over 4x that many seconds, see TempSensor.h
 		/* fridgeFastFilter */ 1u,
 		/* fridgeSlowFilter */ 4u,
 		/* fridgeSlopeFilter */ 3u,
@@ -118,10 +118,10 @@ struct ControlConstants
 	// for the filter coefficients the b value is stored. a is calculated from b.
 	uint8_t fridgeFastFilter;  // for display, logging and on-off control
 	uint8_t fridgeSlowFilter;  // for peak detection
-	uint8_t fridgeSlopeFilter; // not used in current control algorithm
+	uint8_t fridgeSlopeFilter; // not used in current control algorithm. 8 or more: least squares fit over 4x seconds
 	uint8_t beerFastFilter;	// for display and logging
 	uint8_t beerSlowFilter;	// for on/off control algorithm
-	uint8_t beerSlopeFilter;   // for PID calculation
+	uint8_t beerSlopeFilter;   // for PID calculation. 8 or more: least squares fit over 4x seconds
 	uint8_t lightAsHeater;	 // use the light to heat rather than the configured heater device
 	uint8_t rotaryHalfSteps;   // define whether to use full or half steps for the rotary encoder
 	temperature pidMax;
@@ -167,7 +167,7 @@ enum states
  * we swap in/out the sensors and control data so that the bulk of the code
  * can work against compile-time resolvable memory references. While the
  * design goes against the grain of typical OO practices, the reduction in
- * code size make it worth it.
+ * code size make it worth it. See ChamberManager.
  */
 
 class TempControl
@@ -207,6 +207,11 @@ class TempControl
 	TEMP_CONTROL_METHOD temperature getFridgeSetting(void);
 	TEMP_CONTROL_METHOD void setFridgeTemp(temperature newTemp);
 
+	// Change a setting without running the controller. The caller runs updatePID() and updateState() once,
+	// after all settings of a message are changed.
+	TEMP_CONTROL_METHOD void changeBeerSetting(temperature newTemp);
+	TEMP_CONTROL_METHOD void changeFridgeSetting(temperature newTemp);
+
 	TEMP_CONTROL_METHOD humidity getFridgeHumidity(void);
 	TEMP_CONTROL_METHOD temperature getRoomTemp(void)
 	{
@@ -304,6 +309,7 @@ class TempControl
 	TEMP_CONTROL_FIELD bool doPosPeakDetect;
 	TEMP_CONTROL_FIELD bool doNegPeakDetect;
 	TEMP_CONTROL_FIELD bool doorOpen;
+	TEMP_CONTROL_FIELD uint8_t integralUpdateCounter;
 
 	friend class TempControlState;
 };
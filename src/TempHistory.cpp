@@ -0,0 +1,172 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "TempHistory.h"
+#include "TempControl.h"
+
+#if BREWPI_TEMP_HISTORY
+
+#define HISTORY_NO_VALUE INT8_MIN
+#define HISTORY_STATE_MASK 0x0F
+#define HISTORY_ABSOLUTE_FLAG(channel) (0x10 << (channel))
+#define HISTORY_DIFF_SHIFT 5	 // 1/16 degree
+#define HISTORY_ABSOLUTE_SHIFT 8 // 1/2 degree
+
+#if defined(__AVR_ATmega328P__)
+// The Uno has 2 KB of RAM, most of it already used by the rest of the firmware
+static_assert(TEMP_HISTORY_SAMPLES * sizeof(TempHistorySample) <= 384, "TEMP_HISTORY_SAMPLES does not fit in the RAM of an ATmega328P");
+#endif
+
+TempHistorySample TempHistory::samples[TEMP_HISTORY_SAMPLES];
+uint16_t TempHistory::oldest;
+uint16_t TempHistory::count;
+uint16_t TempHistory::nextSequence;
+ticks_seconds_t TempHistory::lastSample;
+temperature TempHistory::newestTemps[NUM_HISTORY_CHANNELS] = {INVALID_TEMP, INVALID_TEMP, INVALID_TEMP};
+temperature TempHistory::baseTemps[NUM_HISTORY_CHANNELS] = {INVALID_TEMP, INVALID_TEMP, INVALID_TEMP};
+
+void TempHistory::update()
+{
+	if (count == 0 || ticks.timeSince(lastSample) >= TEMP_HISTORY_INTERVAL)
+	{
+		lastSample = ticks.seconds();
+		addSample();
+	}
+}
+
+static int8_t roundedShift(int32_t value, uint8_t shift)
+{
+	int32_t rounded = (value + (1 << (shift - 1))) >> shift;
+	return constrain(rounded, INT8_MIN + 1, INT8_MAX);
+}
+
+int8_t TempHistory::encode(temperature &reference, temperature value, bool &absolute)
+{
+	int8_t code;
+	absolute = false;
+	if (isDisabledOrInvalid(value))
+	{
+		code = HISTORY_NO_VALUE;
+	}
+	else
+	{
+		const int32_t maxDiff = int32_t(INT8_MAX) << HISTORY_DIFF_SHIFT;
+		int32_t diff = int32_t(value) - reference;
+		absolute = isDisabledOrInvalid(reference) || diff > maxDiff || diff < -maxDiff;
+		code = absolute ? roundedShift(value, HISTORY_ABSOLUTE_SHIFT) : roundedShift(diff, HISTORY_DIFF_SHIFT);
+	}
+	decode(reference, code, absolute); // the reference follows what the script will decode
+	return code;
+}
+
+temperature TempHistory::decode(temperature &reference, int8_t code, bool absolute)
+{
+	if (absolute)
+	{
+		reference = temperature(code) * (1 << HISTORY_ABSOLUTE_SHIFT);
+	}
+	else if (code == HISTORY_NO_VALUE)
+	{
+		return INVALID_TEMP;
+	}
+	else
+	{
+		reference += temperature(code) * (1 << HISTORY_DIFF_SHIFT);
+	}
+	return reference;
+}
+
+void TempHistory::addSample()
+{
+	uint16_t index = oldest + count;
+	if (count == TEMP_HISTORY_SAMPLES)
+	{
+		// drop the oldest sample, the values before the new oldest sample are the ones it decodes to
+		TempHistorySample &dropped = samples[oldest];
+		for (uint8_t i = 0; i < NUM_HISTORY_CHANNELS; i++)
+		{
+			decode(baseTemps[i], dropped.temps[i], dropped.flags & HISTORY_ABSOLUTE_FLAG(i));
+		}
+		oldest = (oldest + 1 == TEMP_HISTORY_SAMPLES) ? 0 : oldest + 1;
+	}
+	else
+	{
+		count++;
+	}
+	if (index >= TEMP_HISTORY_SAMPLES)
+	{
+		index -= TEMP_HISTORY_SAMPLES;
+	}
+
+	temperature temps[NUM_HISTORY_CHANNELS] = {tempControl.getBeerTemp(), tempControl.getFridgeTemp(), tempControl.getRoomTemp()};
+	TempHistorySample &sample = samples[index];
+	sample.flags = tempControl.getState() & HISTORY_STATE_MASK;
+	for (uint8_t i = 0; i < NUM_HISTORY_CHANNELS; i++)
+	{
+		bool absolute;
+		sample.temps[i] = encode(newestTemps[i], temps[i], absolute);
+		if (absolute)
+		{
+			sample.flags |= HISTORY_ABSOLUTE_FLAG(i);
+		}
+	}
+	nextSequence++;
+}
+
+void TempHistory::forEach(uint16_t from, uint8_t maxCount, SampleCallback callback)
+{
+	temperature references[NUM_HISTORY_CHANNELS];
+	temperature temps[NUM_HISTORY_CHANNELS];
+	memcpy(references, baseTemps, sizeof(references));
+
+	// sequence numbers wrap, samples older than the oldest one are no longer available
+	int16_t skip = from - firstSequence();
+	uint16_t sequence = firstSequence();
+	uint16_t index = oldest;
+	for (int16_t n = 0; n < int16_t(count) && maxCount; n++, sequence++)
+	{
+		const TempHistorySample &sample = samples[index];
+		for (uint8_t i = 0; i < NUM_HISTORY_CHANNELS; i++)
+		{
+			temps[i] = decode(references[i], sample.temps[i], sample.flags & HISTORY_ABSOLUTE_FLAG(i));
+		}
+		if (n >= skip)
+		{
+			callback(sequence, temps, sample.flags & HISTORY_STATE_MASK);
+			maxCount--;
+		}
+		if (++index == TEMP_HISTORY_SAMPLES)
+		{
+			index = 0;
+		}
+	}
+}
+
+#endif
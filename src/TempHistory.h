@@ -0,0 +1,106 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+#include "Ticks.h"
+
+/*
+ * Keeps a downsampled history of the beer, fridge and room temperature and
+ * the state of the selected chamber, so the script can fill the gap in its
+ * graph after it reconnects. A sample is taken every TEMP_HISTORY_INTERVAL
+ * seconds, the newest TEMP_HISTORY_SAMPLES samples are kept.
+ *
+ * A sample takes 4 bytes. Each temperature is stored as the difference with
+ * the previous sample in steps of 1/16 degree. When there is no previous
+ * value or the difference is too large, the temperature itself is stored in
+ * steps of 1/2 degree (range -64 to +64 degrees). Later differences correct
+ * the rounding.
+ *
+ * Samples are numbered. The script requests the samples from a number on
+ * with the 'H' command, at most TEMP_HISTORY_PAGE_SIZE or the requested count
+ * per response.
+ *
+ * Enable with BREWPI_TEMP_HISTORY.
+ */
+
+#if BREWPI_TEMP_HISTORY
+
+enum TempHistoryChannel
+{
+	HISTORY_BEER,
+	HISTORY_FRIDGE,
+	HISTORY_ROOM,
+	NUM_HISTORY_CHANNELS
+};
+
+struct TempHistorySample
+{
+	int8_t temps[NUM_HISTORY_CHANNELS]; // difference in 1/16 degree, or value in 1/2 degree when absolute
+	uint8_t flags;						// bits 0-3: state, bits 4-6: temps[i] is absolute
+};
+
+class TempHistory
+{
+  public:
+	typedef void (*SampleCallback)(uint16_t sequence, const temperature *temps, uint8_t state);
+
+	/**
+	 * Takes a sample when TEMP_HISTORY_INTERVAL seconds have passed. Called every second.
+	 */
+	static void update();
+
+	/**
+	 * Decodes up to maxCount stored samples with a sequence number from 'from' on, oldest first.
+	 */
+	static void forEach(uint16_t from, uint8_t maxCount, SampleCallback callback);
+
+	static uint16_t firstSequence() { return nextSequence - count; }
+	static uint16_t sampleCount() { return count; }
+
+	// Seconds since the newest sample was taken
+	static ticks_seconds_t age() { return ticks.timeSince(lastSample); }
+
+  private:
+	static void addSample();
+	static int8_t encode(temperature &reference, temperature value, bool &absolute);
+	static temperature decode(temperature &reference, int8_t code, bool absolute);
+
+	static TempHistorySample samples[TEMP_HISTORY_SAMPLES];
+	static uint16_t oldest;		  // index of the oldest sample
+	static uint16_t count;		  // number of stored samples
+	static uint16_t nextSequence; // sequence number of the next sample
+	static ticks_seconds_t lastSample;
+	static temperature newestTemps[NUM_HISTORY_CHANNELS]; // decoded values of the newest sample
+	static temperature baseTemps[NUM_HISTORY_CHANNELS];	  // decoded values before the oldest sample
+};
+
+#endif
@@ -41,9 +41,21 @@ void TempSensor::init()
         if (temp != TEMP_SENSOR_DISCONNECTED)
         {
             // logDebug("initializing filters with value %d", temp);
+#if TEMP_SENSOR_OUTLIER_WINDOW
+            outlierFilter.init(temp);
+#endif
             fastFilter.init(temp);
             slowFilter.init(temp);
             slopeFilter.init(0);
+#if TEMP_SENSOR_PEAK_DETECTOR
+            peakDetector.init(slowFilter.readOutputDoublePrecision());
+#endif
+#if TEMP_SENSOR_SLOPE_REGRESSION
+            if (slopeRegression)
+            {
+                slopeRegression->init(fastFilter.readOutput());
+            }
+#endif
             prevOutputForSlope = slowFilter.readOutputDoublePrecision();
             failedReadCount = 0;
         }
@@ -62,8 +74,22 @@ void TempSensor::update()
         return;
     }
 
+#if TEMP_SENSOR_OUTLIER_WINDOW
+    temp = outlierFilter.add(temp);
+#endif
     fastFilter.add(temp);
     slowFilter.add(temp);
+#if TEMP_SENSOR_PEAK_DETECTOR
+    peakDetector.add(slowFilter.readOutputDoublePrecision());
+#endif
+
+#if TEMP_SENSOR_SLOPE_REGRESSION
+    if (slopeRegression)
+    {
+        slopeRegression->add(fastFilter.readOutput());
+        return;
+    }
+#endif
 
     // update slope filter every 3 samples.
     // averaged differences will give the slope. Use the slow filter as input
@@ -100,6 +126,12 @@ temperature TempSensor::readFastFiltered(void)
 
 temperature TempSensor::readSlope(void)
 {
+#if TEMP_SENSOR_SLOPE_REGRESSION
+    if (slopeRegression)
+    {
+        return slopeRegression->readSlope();
+    }
+#endif
     // return slope per hour.
     temperature_precise doublePrecision = slopeFilter.readOutputDoublePrecision();
     return doublePrecision >> 16; // shift to single precision
@@ -107,12 +139,20 @@ temperature TempSensor::readSlope(void)
 
 temperature TempSensor::detectPosPeak(void)
 {
+#if TEMP_SENSOR_PEAK_DETECTOR
+    return peakDetector.posPeak();
+#else
     return slowFilter.detectPosPeak();
+#endif
 }
 
 temperature TempSensor::detectNegPeak(void)
 {
+#if TEMP_SENSOR_PEAK_DETECTOR
+    return peakDetector.negPeak();
+#else
     return slowFilter.detectNegPeak();
+#endif
 }
 
 void TempSensor::setFastFilterCoefficients(uint8_t b)
@@ -127,6 +167,33 @@ void TempSensor::setSlowFilterCoefficients(uint8_t b)
 
 void TempSensor::setSlopeFilterCoefficients(uint8_t b)
 {
+#if TEMP_SENSOR_SLOPE_REGRESSION
+    if (b >= TEMP_SENSOR_SLOPE_REGRESSION_SETTING)
+    {
+        uint16_t window = b * TEMP_SENSOR_SLOPE_REGRESSION_SCALE;
+        if (slopeRegression && slopeRegression->getWindow() == window)
+        {
+            return; // unchanged, keep the samples
+        }
+        // malloc returns NULL when the heap is full, plain new on AVR would run the constructor on NULL
+        free(slopeRegression);
+        slopeRegression = (LeastSquaresSlope *)malloc(sizeof(LeastSquaresSlope));
+        if (slopeRegression)
+        {
+            slopeRegression->setWindow(window);
+            slopeRegression->init(fastFilter.readOutput());
+            return;
+        }
+        b = TEMP_SENSOR_SLOPE_REGRESSION_SETTING - 1; // out of memory, use the slowest slope filter
+    }
+    free(slopeRegression);
+    slopeRegression = NULL;
+#else
+    if (b >= TEMP_SENSOR_SLOPE_REGRESSION_SETTING)
+    {
+        b = TEMP_SENSOR_SLOPE_REGRESSION_SETTING - 1; // not supported, use the slowest slope filter
+    }
+#endif
     slopeFilter.setCoefficients(b);
 }
 
@@ -31,6 +31,11 @@ license and credits. */
 
 #include "Brewpi.h"
 #include "FilterCascaded.h"
+#if TEMP_SENSOR_SLOPE_REGRESSION
+#include "FilterLeastSquares.h"
+#endif
+#include "FilterOutlier.h"
+#include "PeakDetector.h"
 #include "TempSensorBasic.h"
 #include <stdlib.h>
 
@@ -41,6 +46,11 @@ license and credits. */
 #define TEMP_SENSOR_CASCADED_FILTER 1
 #endif
 
+// Slope filter settings from this value on select a least squares fit over 4 * setting seconds
+// of the fast filter output instead of the slope filter
+#define TEMP_SENSOR_SLOPE_REGRESSION_SETTING 8
+#define TEMP_SENSOR_SLOPE_REGRESSION_SCALE 4u
+
 #if TEMP_SENSOR_CASCADED_FILTER
 typedef CascadedFilter TempSensorFilter;
 #else
@@ -59,9 +69,19 @@ class TempSensor
 	TempSensor(TempSensorType sensorType, BasicTempSensor *sensor = NULL)
 	{
 		updateCounter = 255; // first update for slope filter after (255-4s)
+#if TEMP_SENSOR_SLOPE_REGRESSION
+		slopeRegression = NULL;
+#endif
 		setSensor(sensor);
 	}
 
+#if TEMP_SENSOR_SLOPE_REGRESSION
+	~TempSensor()
+	{
+		free(slopeRegression);
+	}
+#endif
+
 	void setSensor(BasicTempSensor *sensor)
 	{
 		_sensor = sensor;
@@ -91,19 +111,44 @@ class TempSensor
 
 	temperature detectNegPeak(void);
 
+#if TEMP_SENSOR_PEAK_DETECTOR
+	const PeakDetector &peaks() const
+	{
+		return peakDetector;
+	}
+#endif
+
+#if TEMP_SENSOR_OUTLIER_WINDOW
+	// readings replaced by the median of the last readings
+	uint16_t rejectedSamples() const
+	{
+		return outlierFilter.rejectedCount();
+	}
+#endif
+
 	void setFastFilterCoefficients(uint8_t b);
 
 	void setSlowFilterCoefficients(uint8_t b);
 
+	// Values below TEMP_SENSOR_SLOPE_REGRESSION_SETTING set the b value of the slope filter.
 	void setSlopeFilterCoefficients(uint8_t b);
 
 	BasicTempSensor &sensor();
 
   private:
 	BasicTempSensor *_sensor;
+#if TEMP_SENSOR_OUTLIER_WINDOW
+	OutlierFilter outlierFilter;
+#endif
 	TempSensorFilter fastFilter;
 	TempSensorFilter slowFilter;
 	TempSensorFilter slopeFilter;
+#if TEMP_SENSOR_SLOPE_REGRESSION
+	LeastSquaresSlope *slopeRegression; // replaces the slope filter when not NULL
+#endif
+#if TEMP_SENSOR_PEAK_DETECTOR
+	PeakDetector peakDetector;			// peaks of the slow filter output
+#endif
 	unsigned char updateCounter;
 	temperature_precise prevOutputForSlope;
 
@@ -32,7 +32,6 @@ license and credits. */
 #include "Platform.h"
 #include "TempControl.h"
 #include <string.h>
-#include <stdarg.h>
 
 // See header file for details about the temp format used.
 
@@ -63,14 +62,23 @@ char *fixedPointToString(char *s, temperature rawValue, uint8_t numDecimals, uin
     return fixedPointToString(s, long_temperature(rawValue), numDecimals, maxLength);
 }
 
-// this gets rid of snprintf_P
-
-void mysnprintf_P(char *buf, int len, const char *fmt, ...)
+// Writes the digits of val, padded with zeros to at least minDigits, and returns a pointer to the terminating 0.
+// Replaces sprintf_P("%u") and "%02u", which pull in the printf core and are much slower.
+char *uintToString(char *s, uint16_t val, uint8_t minDigits)
 {
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf_P(buf, len, fmt, args);
-    va_end(args); 
+    char digits[5];
+    uint8_t n = 0;
+    do
+    {
+        digits[n++] = '0' + val % 10;
+        val /= 10;
+    } while (val || n < minDigits);
+    while (n)
+    {
+        *s++ = digits[--n];
+    }
+    *s = '\0';
+    return s;
 }
 
 char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
@@ -81,22 +89,19 @@ char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals
         s[0] = '-';
         rawValue = -rawValue;
     }
-    int intPart = rawValue >> TEMP_FIXED_POINT_BITS; // do not use longTempDiffToInt because it rounds up
+    uint16_t intPart = rawValue >> TEMP_FIXED_POINT_BITS; // do not use longTempDiffToInt because it rounds up
     uint16_t fracPart;
-    const char *fmt;
     uint16_t scale;
     switch (numDecimals)
     {
     case 1:
-        fmt = PSTR("%d.%01d");
         scale = 10;
         break;
     case 2:
-        fmt = PSTR("%d.%02d");
         scale = 100;
         break;
     default:
-        fmt = PSTR("%d.%03d");
+        numDecimals = 3;
         scale = 1000;
     }
     fracPart = ((rawValue & TEMP_FIXED_POINT_MASK) * scale + TEMP_FIXED_POINT_SCALE / 2) >> TEMP_FIXED_POINT_BITS; // add 256 for rounding
@@ -105,10 +110,31 @@ char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals
         intPart++;
         fracPart = 0;
     }
-    mysnprintf_P(&s[1], maxLength - 1, fmt, intPart, fracPart);
+    // sign + 5 digits integer part + point + 3 digits fraction part + '\0'
+    char number[11];
+    char *end = uintToString(number, intPart, 1);
+    *end++ = '.';
+    uintToString(end, fracPart, numDecimals);
+
+    // keep at most maxLength - 1 bytes including the '\0' after the sign, like snprintf did
+    uint8_t i = 1;
+    for (const char *p = number; *p && i < maxLength - 1; p++)
+    {
+        s[i++] = *p;
+    }
+    s[i] = '\0';
     return s;
 }
 
+// Parsed values beyond this are saturated before the conversion to C or F, so the scaling cannot overflow.
+// It is far outside the range of temperature, so the result is saturated by constrainTemp16 in both cases.
+#define PARSED_TEMP_LIMIT (long_temperature(1) << 24)
+
+static long_temperature constrainParsedTemp(long_temperature val)
+{
+    return constrain(val, -PARSED_TEMP_LIMIT, PARSED_TEMP_LIMIT);
+}
+
 bool stringToTemp(temperature *result, const char *numberString)
 {
     if (0 == strcmp(PSTR("null"), numberString))
@@ -119,7 +145,7 @@ bool stringToTemp(temperature *result, const char *numberString)
     long_temperature longResult;
     if (stringToFixedPoint(&longResult, numberString))
     {
-        *result = constrainTemp16(convertToInternalTemp(longResult));
+        *result = constrainTemp16(convertToInternalTemp(constrainParsedTemp(longResult)));
         return true;
     }
     return false;
@@ -130,7 +156,7 @@ bool stringToTempDiff(temperature *result, const char *numberString)
     long_temperature longResult;
     if (stringToFixedPoint(&longResult, numberString))
     {
-        longResult = convertToInternalTempDiff(longResult);
+        longResult = convertToInternalTempDiff(constrainParsedTemp(longResult));
         *result = constrainTemp16(longResult);
         return true;
     }
@@ -143,41 +169,96 @@ bool invalidStrtolResult(const char *start, const char *end)
             || start == end);                            // no number found in string
 }
 
-bool stringToFixedPoint(long_temperature *result, const char *numberString)
+// Accepts leading spaces, at most one minus sign directly before the number, digits with an optional
+// decimal point, and trailing spaces. At least one digit is required. Integer parts that do not fit
+// 32 bits saturate, digits after the 10th decimal are ignored.
+bool parseDecimal(ParsedDecimal *result, const char *numberString)
 {
-    // receive new temperature as null terminated string: "19.20"
-    long_temperature newValue;
-    long_temperature decimalValue = 0;
-    char *decimalPtr;
-    char *end;
-    // Check if - is in the string
-    bool positive = (0 == strchr(numberString, '-'));
-
-    newValue = strtol_impl(numberString, &end); // convert string to integer
-    if (invalidStrtolResult(numberString, end))
+    const char *p = numberString;
+    while (*p == ' ')
     {
-        return false; // string was not valid
+        p++;
     }
-    newValue = newValue << TEMP_FIXED_POINT_BITS; // shift to fixed point
-
-    // find the point in the string to know whether we have decimals
-    decimalPtr = strchr(numberString, '.'); // returns pointer to the point.
-    if (decimalPtr != 0)
+    bool negative = (*p == '-');
+    if (negative)
     {
-        decimalPtr++; // skip decimal point
-        // convert decimals to integer
-        decimalValue = strtol_impl(decimalPtr, &end) << TEMP_FIXED_POINT_BITS;
-        if (invalidStrtolResult(decimalPtr, end))
+        p++;
+    }
+    const char *firstDigit = p;
+    uint32_t intPart = 0;
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+        intPart = (intPart > (UINT32_MAX - 9) / 10) ? UINT32_MAX : intPart * 10 + (*p - '0');
+    }
+    uint32_t fraction = 0;
+    uint8_t decimals = 0;
+    uint8_t roundDigit = 0;
+    if (*p == '.')
+    {
+        for (p++; *p >= '0' && *p <= '9'; p++)
         {
-            return false; // string was not valid
+            if (decimals < 9)
+            {
+                fraction = fraction * 10 + (*p - '0');
+                decimals++;
+            }
+            else if (decimals == 9)
+            {
+                roundDigit = *p - '0';
+                decimals++;
+            }
         }
-        uint8_t charsAfterPoint = end - decimalPtr; // actually used # digits after point
-        while (charsAfterPoint-- > 0)
+        if (p == firstDigit + 1)
         {
-            decimalValue = (decimalValue + 5) / 10;
+            return false; // only a point
         }
     }
-    *result = positive ? newValue + decimalValue : newValue - decimalValue;
+    if (p == firstDigit)
+    {
+        return false; // no number
+    }
+    while (*p == ' ')
+    {
+        p++;
+    }
+    if (*p != '\0')
+    {
+        return false; // not only a number
+    }
+    for (; decimals < 9; decimals++)
+    {
+        fraction *= 10;
+    }
+    result->intPart = intPart;
+    result->fraction = fraction;
+    result->roundDigit = roundDigit;
+    result->negative = negative;
+    return true;
+}
+
+bool stringToFixedPoint(long_temperature *result, const char *numberString)
+{
+    // receive new temperature as null terminated string: "19.20"
+    ParsedDecimal parsed;
+    if (!parseDecimal(&parsed, numberString))
+    {
+        return false; // string was not valid
+    }
+    // one fraction step of fixed point is 10^9 / 512 = 1953125 billionths. Round half away from zero,
+    // the 10th decimal decides when the remainder is just below the half step.
+    const uint32_t step = 1953125;
+    uint16_t fracPart = parsed.fraction / step;
+    uint32_t remainder = parsed.fraction % step;
+    if (remainder > step / 2 || (remainder == step / 2 && parsed.roundDigit >= 5))
+    {
+        fracPart++;
+    }
+    uint32_t value = INT32_MAX; // saturate large values, INT32_MIN stays free for INVALID_TEMP_LONG
+    if (parsed.intPart < (uint32_t(1) << (31 - TEMP_FIXED_POINT_BITS)))
+    {
+        value = min((parsed.intPart << TEMP_FIXED_POINT_BITS) + fracPart, uint32_t(INT32_MAX));
+    }
+    *result = parsed.negative ? -long_temperature(value) : long_temperature(value);
     return true;
 }
 
@@ -313,37 +394,35 @@ temperature constrainTemp(long_temperature valLong, temperature lower, temperatu
     return temperature(valLong);
 }
 
+template <>
+Fixed7_9 Fixed7_9::clamp(int32_t raw)
+{
+    return fromRaw(raw_t(raw < minRaw() ? minRaw() : raw > maxRaw() ? maxRaw() : raw));
+}
+
 temperature constrainTemp16(long_temperature val)
 {
-    if (val < MIN_TEMP)
-    {
-        return MIN_TEMP;
-    }
-    if (val > MAX_TEMP)
-    {
-        return MAX_TEMP;
-    }
-    return val;
+    return Fixed7_9::clamp(val).raw();
 }
 
 temperature multiplyFactorTemperatureLong(temperature factor, long_temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * (b - C_OFFSET)) >> TEMP_FIXED_POINT_BITS);
+    return Fixed7_9::fromRaw(factor).saturatingMul(Fixed23_9::fromRaw(b - C_OFFSET)).raw();
 }
 
 temperature multiplyFactorTemperatureDiffLong(temperature factor, long_temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * b) >> TEMP_FIXED_POINT_BITS);
+    return Fixed7_9::fromRaw(factor).saturatingMul(Fixed23_9::fromRaw(b)).raw();
 }
 
 temperature multiplyFactorTemperature(temperature factor, temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * ((long_temperature)b - C_OFFSET)) >> TEMP_FIXED_POINT_BITS);
+    return Fixed7_9::fromRaw(factor).saturatingMul(Fixed23_9::fromRaw((long_temperature)b - C_OFFSET)).raw();
 }
 
 temperature multiplyFactorTemperatureDiff(temperature factor, temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * (long_temperature)b) >> TEMP_FIXED_POINT_BITS);
+    return Fixed7_9::fromRaw(factor).saturatingMul(Fixed7_9::fromRaw(b)).raw();
 }
 
 long int my_strtol(const char *str, char **tail)
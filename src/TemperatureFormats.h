@@ -30,6 +30,7 @@ license and credits. */
 #pragma once
 
 #include "Brewpi.h"
+#include "FixedPoint.h"
 #include <stdint.h>
 
 #ifndef INT16_MAX
@@ -107,9 +108,20 @@ char *tempToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint
 char *tempDiffToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength);
 char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength);
 char *fixedPointToString(char *s, temperature rawValue, uint8_t numDecimals, uint8_t maxLength);
+char *uintToString(char *s, uint16_t val, uint8_t minDigits);
+
+// A decimal number split in parts without rounding. The fraction holds the first 9 digits after the point.
+struct ParsedDecimal
+{
+    uint32_t intPart;   // saturated at UINT32_MAX
+    uint32_t fraction;  // billionths
+    uint8_t roundDigit; // 10th digit after the point
+    bool negative;
+};
 
 // On succesful conversion, these functions write the result and return
 // Result is not written on failure and false is returned
+bool parseDecimal(ParsedDecimal *result, const char *numberString);
 bool stringToFixedPoint(temperature *result, const char *numberString);
 bool stringToFixedPoint(long_temperature *result, const char *numberString);
 bool stringToTempDiff(temperature *result, const char *string);
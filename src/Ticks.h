@@ -31,9 +31,14 @@ license and credits. */
 
 #include "Brewpi.h"
 #include "Platform.h"
-#include "TicksImpl.h"
 #include <stdint.h>
 
+typedef uint16_t tcduration_t;
+typedef uint32_t ticks_millis_t;
+typedef uint32_t ticks_micros_t;
+typedef uint16_t ticks_seconds_t;
+typedef uint8_t ticks_seconds_tiny_t;
+
 /**
  * Ticks - interface to a millisecond timer
  *
@@ -108,3 +113,6 @@ inline ticks_seconds_t timeSince(ticks_seconds_t currentTime, ticks_seconds_t pr
 		return (currentTime + 1440) - (previousTime + 1440); // add a day to both for calculation
 	}
 }
+
+// TicksImpl.h selects among the classes above, so it is included after them
+#include "TicksImpl.h"
@@ -85,7 +85,6 @@ void UI::update()
 	display.printState();
 	display.printAllTemperatures();
 	display.printMode();
-	display.updateBacklight();
 }
 
 bool UI::inStartup() { return false; }
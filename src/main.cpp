@@ -56,6 +56,8 @@ void handleReset()
 // 	// A no-op. This is not used on this platform.
 // }
 
+// Unit tests use the main() of the Arduino core, which calls their setup() and loop()
+#ifndef PIO_UNIT_TESTING
 int main(void)
 {
 	init();
@@ -74,6 +76,7 @@ int main(void)
 	}
 	return 0;
 }
+#endif
 
 // Catch bad interrupts here, uncomment while only when debugging
 // ISR(BADISR_vect)
@@ -0,0 +1,83 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+/* Cycle counting for the AVR benchmarks ([env:bench] in platformio.ini, run in simavr or on an Uno).
+ * Timer1 runs without prescaler, so it counts CPU cycles. Measured code must take less than 65536 cycles.
+ * Include it from the test_main.cpp of a test only.
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <unity.h>
+
+class CycleCounter
+{
+  public:
+	// Takes Timer1 from the Arduino core (PWM on pins 9 and 10) and measures the overhead of a measurement
+	static void begin()
+	{
+		TCCR1A = 0;
+		TCCR1B = _BV(CS10);
+		overhead = 0;
+		overhead = measure([]() {});
+	}
+
+	// Returns the number of cycles f() takes, with interrupts disabled, or UINT16_MAX when the timer overflowed
+	template <typename F>
+	static uint16_t measure(F f)
+	{
+		uint8_t oldSREG = SREG;
+		cli();
+		TIFR1 = _BV(TOV1);
+		TCNT1 = 0;
+		asm volatile("" ::: "memory");
+		f();
+		asm volatile("" ::: "memory");
+		uint16_t end = TCNT1;
+		bool overflowed = TIFR1 & _BV(TOV1);
+		SREG = oldSREG;
+		return overflowed ? UINT16_MAX : end - overhead;
+	}
+
+  private:
+	static uint16_t overhead;
+};
+
+uint16_t CycleCounter::overhead;
+
+// Prints a result as a test message, so it shows up in the output of pio test
+inline void reportCycles(const char *what, uint16_t cycles)
+{
+	char message[80];
+	snprintf(message, sizeof(message), "%s: %u cycles", what, cycles);
+	TEST_MESSAGE(message);
+	TEST_ASSERT_TRUE_MESSAGE(cycles != UINT16_MAX, "measured code fits in 65535 cycles");
+}
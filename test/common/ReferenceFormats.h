@@ -0,0 +1,98 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* Shared by the native and AVR tests: the vsnprintf_P based formatting of TemperatureFormats.cpp before it stopped
+ * using printf, as the reference for the printf free code.
+ */
+
+#pragma once
+
+#include "TemperatureFormats.h"
+#include <stdarg.h>
+#include <string.h>
+
+inline void referenceSnprintf_P(char *buf, int len, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf_P(buf, len, fmt, args);
+	va_end(args);
+}
+
+// fixedPointToString() before it stopped using printf. int is 16 bits on AVR.
+inline char *referenceFixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
+{
+	s[0] = ' ';
+	if (rawValue < 0l)
+	{
+		s[0] = '-';
+		rawValue = -rawValue;
+	}
+	int16_t intPart = rawValue >> TEMP_FIXED_POINT_BITS;
+	uint16_t fracPart;
+	const char *fmt;
+	uint16_t scale;
+	switch (numDecimals)
+	{
+	case 1:
+		fmt = PSTR("%d.%01d");
+		scale = 10;
+		break;
+	case 2:
+		fmt = PSTR("%d.%02d");
+		scale = 100;
+		break;
+	default:
+		fmt = PSTR("%d.%03d");
+		scale = 1000;
+	}
+	fracPart = ((rawValue & TEMP_FIXED_POINT_MASK) * scale + TEMP_FIXED_POINT_SCALE / 2) >> TEMP_FIXED_POINT_BITS;
+	if (fracPart >= scale)
+	{
+		intPart++;
+		fracPart = 0;
+	}
+	referenceSnprintf_P(&s[1], maxLength - 1, fmt, int(intPart), int(fracPart));
+	return s;
+}
+
+inline char *referenceTempToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
+{
+	if (isDisabledOrInvalid(rawValue))
+	{
+		strcpy_P(s, PSTR("null"));
+		return s;
+	}
+	return referenceFixedPointToString(s, convertFromInternalTemp(rawValue), numDecimals, maxLength);
+}
+
+inline char *referenceTempDiffToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
+{
+	return referenceFixedPointToString(s, convertFromInternalTempDiff(rawValue), numDecimals, maxLength);
+}
@@ -0,0 +1,88 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+/* Shared helpers for the native tests. Include it from the test_main.cpp of a test only: it defines the
+ * control constants that TemperatureFormats.cpp reads, which the firmware defines in TempControl.cpp.
+ */
+
+#include "Brewpi.h"
+#include "TempControl.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <unity.h>
+
+ControlConstants TempControl::cc;
+
+// Deterministic pseudo random numbers (xorshift32), so every run of a test sees the same input
+class TestRandom
+{
+  public:
+	TestRandom(uint32_t seed = 2463534242u) : state(seed) {}
+
+	uint32_t next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// uniform in [-range, range]
+	int32_t nextInRange(int32_t range)
+	{
+		return int32_t(next() % (2 * uint32_t(range) + 1)) - range;
+	}
+
+  private:
+	uint32_t state;
+};
+
+// Runs f() count times and returns the average time per call in nanoseconds
+template <typename F>
+double nanosPerCall(uint32_t count, F f)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		f(i);
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / count;
+}
+
+// Prints a benchmark result as a test message, so it shows up in the output of pio test
+inline void reportTiming(const char *what, double nanos)
+{
+	char message[100];
+	snprintf(message, sizeof(message), "%s: %.1f ns per call", what, nanos);
+	TEST_MESSAGE(message);
+}
@@ -0,0 +1,64 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+/* Print and Stream interfaces of the Arduino core, declarations only, for the native test environment. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+class __FlashStringHelper;
+
+class Print
+{
+  public:
+	virtual size_t write(uint8_t) = 0;
+	size_t write(const char *str);
+	size_t write(const uint8_t *buffer, size_t size);
+	size_t print(const char *str);
+	size_t print(const __FlashStringHelper *str);
+	size_t print(char c);
+	size_t print(int n, int base = 10);
+	size_t print(unsigned int n, int base = 10);
+	size_t print(long n, int base = 10);
+	size_t print(unsigned long n, int base = 10);
+	size_t println(const char *str);
+	size_t println(char c);
+	size_t println();
+};
+
+class Stream : public Print
+{
+  public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() {}
+};
@@ -0,0 +1,109 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* Cycles per sample of the cascaded filter on AVR, for b = 0..6: the variable shift code in FilterFixed.cpp
+ * against the constant shift kernels of FilterCascaded.h, and CascadedFilter::add() as built with the current
+ * FILTER_CONSTANT_SHIFTS. Run with: pio test -e bench -f test_avr_filter_cycles
+ */
+
+#include "../avr/CycleCounter.h"
+#include "Brewpi.h"
+#include "FilterCascaded.h"
+#include <unity.h>
+
+static volatile temperature_precise sink;
+
+template <uint8_t B>
+static void compareKernels(void)
+{
+	CascadedFilter variable;
+	CascadedFilter constant;
+	variable.setCoefficients(B);
+	constant.setCoefficients(B);
+	variable.init(intToTemp(20));
+	constant.init(intToTemp(20));
+	temperature_precise in = tempRegularToPrecise(intToTemp(21));
+	temperature_precise expected = 0;
+	temperature_precise result = 0;
+
+	// the first samples after a step, so the values are not all equal
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		uint16_t variableCycles = CycleCounter::measure([&]() {
+			expected = in;
+			for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+			{
+				expected = variable.sections[s].addDoublePrecision(expected);
+			}
+		});
+		uint16_t constantCycles = CycleCounter::measure([&]() { result = cascadedFilterKernel<B>(constant.sections, in); });
+		TEST_ASSERT_EQUAL_INT32(expected, result);
+		if (i == 3)
+		{
+			char what[48];
+			snprintf(what, sizeof(what), "b=%d, variable shifts", B);
+			reportCycles(what, variableCycles);
+			snprintf(what, sizeof(what), "b=%d, constant shifts", B);
+			reportCycles(what, constantCycles);
+			TEST_ASSERT_TRUE_MESSAGE(constantCycles <= variableCycles, "constant shifts are not slower");
+		}
+	}
+
+	uint16_t addCycles = CycleCounter::measure([&]() { sink = variable.add(intToTemp(21)); });
+	char what[48];
+	snprintf(what, sizeof(what), "b=%d, CascadedFilter::add", B);
+	reportCycles(what, addCycles);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_filter_cycles(void)
+{
+	compareKernels<0>();
+	compareKernels<1>();
+	compareKernels<2>();
+	compareKernels<3>();
+	compareKernels<4>();
+	compareKernels<5>();
+	compareKernels<6>();
+}
+
+void setup()
+{
+	CycleCounter::begin();
+	UNITY_BEGIN();
+	RUN_TEST(test_filter_cycles);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,80 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* Cycles of tempToString() on AVR against the vsnprintf_P code it replaced, kept in test/common as the
+ * reference. test_native_temp_format checks that both give the same strings.
+ * Run with: pio test -e bench -f test_avr_format_cycles
+ */
+
+#include "../avr/CycleCounter.h"
+#include "../common/ReferenceFormats.h"
+#include "Brewpi.h"
+#include "TempControl.h"
+#include "TemperatureFormats.h"
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_format_cycles(void)
+{
+	const temperature values[] = {intToTemp(0), doubleToTemp(19.87), doubleToTemp(-12.345), intToTemp(100)};
+	for (char format = 'C'; format != 0; format = (format == 'C') ? 'F' : 0)
+	{
+		tempControl.cc.tempFormat = format;
+		for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+		{
+			char expected[12];
+			char result[12];
+			uint16_t printfCycles = CycleCounter::measure([&]() { referenceTempToString(expected, values[i], 2, sizeof(expected)); });
+			uint16_t cycles = CycleCounter::measure([&]() { tempToString(result, values[i], 2, sizeof(result)); });
+			TEST_ASSERT_EQUAL_STRING(expected, result);
+
+			char what[48];
+			snprintf(what, sizeof(what), "%s %c, vsnprintf_P", result, format);
+			reportCycles(what, printfCycles);
+			snprintf(what, sizeof(what), "%s %c, tempToString", result, format);
+			reportCycles(what, cycles);
+			TEST_ASSERT_TRUE_MESSAGE(cycles < printfCycles, "faster than printf");
+		}
+	}
+}
+
+void setup()
+{
+	CycleCounter::begin();
+	UNITY_BEGIN();
+	RUN_TEST(test_format_cycles);
+	UNITY_END();
+}
+
+void loop()
+{
+}
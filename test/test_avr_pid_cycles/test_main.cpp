@@ -0,0 +1,336 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* Cycles of updatePID() and of the fixed point helpers and conversions on AVR, and the saturation of the PID
+ * integral in the real updatePID(). updatePID() must compute the same as the version before the Fixed type, which
+ * is copied below, and must not take more cycles. Flash size is not measured here, compare the size of updatePID
+ * with tools/size_report.sh --symbols before and after.
+ * Run with: pio test -e bench -f test_avr_pid_cycles
+ */
+
+#include "../avr/CycleCounter.h"
+#include "../common/ScriptedTempSensor.h"
+#include "Brewpi.h"
+#include "FixedPoint.h"
+#include "TempControl.h"
+#include "TemperatureFormats.h"
+#include <unity.h>
+
+static ScriptedTempSensor beerInput(intToTemp(20));
+static ScriptedTempSensor fridgeInput(intToTemp(20));
+static TempSensor beer(TEMP_SENSOR_TYPE_BEER, &beerInput);
+static TempSensor fridge(TEMP_SENSOR_TYPE_FRIDGE, &fridgeInput);
+
+static volatile temperature sink;
+static volatile temperature_precise sinkPrecise;
+static volatile long_temperature sinkLong;
+
+/* updatePID() and its helpers before the Fixed type, except that the integral update counter is a variable of the
+ * test. The integral wraps around on overflow here.
+ */
+static uint8_t referenceIntegralUpdateCounter;
+
+static temperature referenceConstrainTemp16(long_temperature val)
+{
+	if (val < MIN_TEMP)
+	{
+		return MIN_TEMP;
+	}
+	if (val > MAX_TEMP)
+	{
+		return MAX_TEMP;
+	}
+	return val;
+}
+
+static temperature referenceMultiplyFactorTemperatureDiffLong(temperature factor, long_temperature b)
+{
+	return referenceConstrainTemp16(((long_temperature)factor * b) >> TEMP_FIXED_POINT_BITS);
+}
+
+static temperature referenceMultiplyFactorTemperatureDiff(temperature factor, temperature b)
+{
+	return referenceConstrainTemp16(((long_temperature)factor * (long_temperature)b) >> TEMP_FIXED_POINT_BITS);
+}
+
+static void referenceUpdatePID(void)
+{
+	ControlConstants &cc = tempControl.cc;
+	ControlSettings &cs = tempControl.cs;
+	ControlVariables &cv = tempControl.cv;
+	if (tempControl.modeIsBeer())
+	{
+		if (isDisabledOrInvalid(cs.beerSetting))
+		{
+			// beer setting is not updated yet
+			// set fridge to unknown too
+			cs.fridgeSetting = DISABLED_TEMP;
+			return;
+		}
+
+		// fridge setting is calculated with PID algorithm. Beer temperature error is input to PID
+		cv.beerDiff = cs.beerSetting - tempControl.beerSensor->readSlowFiltered();
+		cv.beerSlope = tempControl.beerSensor->readSlope();
+		temperature fridgeFastFiltered = tempControl.fridgeSensor->readFastFiltered();
+
+		if (referenceIntegralUpdateCounter++ == 60)
+		{
+			referenceIntegralUpdateCounter = 0;
+
+			temperature integratorUpdate = cv.beerDiff;
+
+			// Only update integrator in IDLE, because thats when the fridge temp has reached the fridge setting.
+			// If the beer temp is still not correct, the fridge setting is too low/high and integrator action is needed.
+			if (tempControl.getState() != IDLE)
+			{
+				integratorUpdate = 0;
+			}
+			else if (abs(integratorUpdate) < cc.iMaxError)
+			{
+				// difference is smaller than iMaxError
+				// check additional conditions to see if integrator should be active to prevent windup
+				bool updateSign = (integratorUpdate > 0); // 1 = positive, 0 = negative
+				bool integratorSign = (cv.diffIntegral > 0);
+
+				if (updateSign == integratorSign)
+				{
+					// beerDiff and integrator have same sign. Integrator would be increased.
+
+					// If actuator is already at max increasing actuator will only cause integrator windup.
+					integratorUpdate = (cs.fridgeSetting >= cc.tempSettingMax) ? 0 : integratorUpdate;
+					integratorUpdate = (cs.fridgeSetting <= cc.tempSettingMin) ? 0 : integratorUpdate;
+					integratorUpdate = ((cs.fridgeSetting - cs.beerSetting) >= cc.pidMax) ? 0 : integratorUpdate;
+					integratorUpdate = ((cs.beerSetting - cs.fridgeSetting) >= cc.pidMax) ? 0 : integratorUpdate;
+
+					// cooling and fridge temp is more than 2 degrees from setting, actuator is saturated.
+					integratorUpdate = (!updateSign && (fridgeFastFiltered > (cs.fridgeSetting + 1024))) ? 0 : integratorUpdate;
+
+					// heating and fridge temp is more than 2 degrees from setting, actuator is saturated.
+					integratorUpdate = (updateSign && (fridgeFastFiltered < (cs.fridgeSetting - 1024))) ? 0 : integratorUpdate;
+				}
+				else
+				{
+					// integrator action is decreased. Decrease faster than increase.
+					integratorUpdate = integratorUpdate * 2;
+				}
+			}
+			else
+			{
+				// decrease integral by 1/8 when far from the end value to reset the integrator
+				integratorUpdate = -(cv.diffIntegral >> 3);
+			}
+			cv.diffIntegral = cv.diffIntegral + integratorUpdate;
+		}
+
+		// calculate PID parts. Use long_temperature to prevent overflow
+		cv.p = referenceMultiplyFactorTemperatureDiff(cc.Kp, cv.beerDiff);
+		cv.i = referenceMultiplyFactorTemperatureDiffLong(cc.Ki, cv.diffIntegral);
+		cv.d = referenceMultiplyFactorTemperatureDiff(cc.Kd, cv.beerSlope);
+		long_temperature newFridgeSetting = cs.beerSetting;
+		newFridgeSetting += cv.p;
+		newFridgeSetting += cv.i;
+		newFridgeSetting += cv.d;
+
+		// constrain to tempSettingMin or beerSetting - pidMAx, whichever is lower.
+		temperature lowerBound = (cs.beerSetting <= cc.tempSettingMin + cc.pidMax) ? cc.tempSettingMin : cs.beerSetting - cc.pidMax;
+		// constrain to tempSettingMax or beerSetting + pidMAx, whichever is higher.
+		temperature upperBound = (cs.beerSetting >= cc.tempSettingMax - cc.pidMax) ? cc.tempSettingMax : cs.beerSetting + cc.pidMax;
+
+		cs.fridgeSetting = constrain(referenceConstrainTemp16(newFridgeSetting), lowerBound, upperBound);
+	}
+	else if (cs.mode == MODE_FRIDGE_CONSTANT)
+	{
+		// FridgeTemperature is set manually, disable beer setpoint
+		cs.beerSetting = DISABLED_TEMP;
+	}
+}
+
+static void beerConstantAt20(void)
+{
+	tempControl.beerSensor = &beer;
+	tempControl.fridgeSensor = &fridge;
+	tempControl.loadDefaultConstants();
+	tempControl.init();
+	beer.init();
+	fridge.init();
+	tempControl.cs.mode = MODE_BEER_CONSTANT;
+	tempControl.cs.beerSetting = intToTemp(20) + 100;
+	tempControl.cs.fridgeSetting = tempControl.cs.beerSetting;
+	referenceIntegralUpdateCounter = 0;
+}
+
+// Runs updatePID() until it has updated the integral, which it does on every 61st call
+static void updateIntegral(void)
+{
+	for (uint8_t i = 0; i < 61; i++)
+	{
+		tempControl.updatePID();
+	}
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/* Behaviour change: the integral used to wrap around on int32_t overflow, flipping the sign of its action. It can
+ * only grow that far when Ki is 0, so that the fridge setting does not limit it, like the glycol defaults.
+ */
+void test_integral_saturates(void)
+{
+	beerConstantAt20();
+	tempControl.cc.Kp = 0;
+	tempControl.cc.Ki = 0;
+	tempControl.cc.Kd = 0;
+
+	tempControl.cv.diffIntegral = INT32_MAX - 50;
+	updateIntegral();
+	TEST_ASSERT_EQUAL_INT16(100, tempControl.cv.beerDiff);
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, tempControl.cv.diffIntegral);
+	updateIntegral();
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, tempControl.cv.diffIntegral);
+
+	tempControl.cs.beerSetting = intToTemp(20) - 100;
+	tempControl.cs.fridgeSetting = tempControl.cs.beerSetting;
+	tempControl.cv.diffIntegral = INT32_MIN + 50;
+	updateIntegral();
+	TEST_ASSERT_EQUAL_INT32(INT32_MIN + 2, tempControl.cv.diffIntegral);
+}
+
+// The beer temperature swings 3 degrees around the setting, with the default constants, so the products and the
+// final saturation see positive and negative values and the fridge setting hits both bounds.
+void test_pid_matches_reference(void)
+{
+	beerConstantAt20();
+	for (uint16_t step = 0; step < 61 * 8; step++)
+	{
+		beerInput.value = intToTemp(20) + intToTemp(3) * (int8_t((step / 61) % 3) - 1) + (step & 0x1F);
+		beer.update();
+		fridge.update();
+		ControlSettings settings = tempControl.cs;
+		ControlVariables variables = tempControl.cv;
+		referenceUpdatePID();
+		ControlSettings referenceSettings = tempControl.cs;
+		ControlVariables referenceVariables = tempControl.cv;
+		tempControl.cs = settings;
+		tempControl.cv = variables;
+		tempControl.updatePID();
+		TEST_ASSERT_EQUAL_INT16(referenceVariables.p, tempControl.cv.p);
+		TEST_ASSERT_EQUAL_INT16(referenceVariables.i, tempControl.cv.i);
+		TEST_ASSERT_EQUAL_INT16(referenceVariables.d, tempControl.cv.d);
+		TEST_ASSERT_EQUAL_INT32(referenceVariables.diffIntegral, tempControl.cv.diffIntegral);
+		TEST_ASSERT_EQUAL_INT16(referenceSettings.fridgeSetting, tempControl.cs.fridgeSetting);
+	}
+}
+
+// Calls f() 61 times, so the integral is updated on the last call. Returns the cycles of the worst other call.
+template <typename F>
+static uint16_t worstPidCycles(F f, uint16_t *withIntegral)
+{
+	beerConstantAt20();
+	tempControl.cv.diffIntegral = 1000;
+	uint16_t worst = 0;
+	for (uint8_t i = 0; i < 61; i++)
+	{
+		uint16_t cycles = CycleCounter::measure(f);
+		if (i == 60)
+		{
+			*withIntegral = cycles;
+		}
+		else if (cycles > worst)
+		{
+			worst = cycles;
+		}
+	}
+	return worst;
+}
+
+void test_pid_cycles(void)
+{
+	uint16_t withIntegral;
+	uint16_t referenceWithIntegral;
+	uint16_t worst = worstPidCycles([]() { tempControl.updatePID(); }, &withIntegral);
+	uint16_t referenceWorst = worstPidCycles([]() { referenceUpdatePID(); }, &referenceWithIntegral);
+	reportCycles("updatePID", worst);
+	reportCycles("updatePID before Fixed", referenceWorst);
+	reportCycles("updatePID, integral update", withIntegral);
+	reportCycles("updatePID before Fixed, integral update", referenceWithIntegral);
+
+	long_temperature integral = INT32_MAX - 50;
+	temperature update = tempControl.cv.beerDiff;
+	uint16_t wrapping = CycleCounter::measure([&]() { sinkLong = integral + update; });
+	uint16_t saturating = CycleCounter::measure([&]() {
+		sinkLong = Fixed23_9::fromRaw(integral).saturatingAdd(Fixed7_9::fromRaw(update).widen<23, 9>()).raw();
+	});
+	reportCycles("integral, wrapping add", wrapping);
+	reportCycles("integral, saturatingAdd", saturating);
+
+	TEST_ASSERT_TRUE_MESSAGE(worst <= referenceWorst, "updatePID is no slower than before the Fixed type");
+	// the saturation of the integral is the only addition
+	TEST_ASSERT_TRUE_MESSAGE(withIntegral <= referenceWithIntegral + (saturating - wrapping),
+							 "integral update is no slower than before the Fixed type and the saturating add");
+}
+
+void test_helper_cycles(void)
+{
+	temperature factor = doubleToTempDiff(5.0);
+	temperature diff = doubleToTempDiff(-1.25);
+	long_temperature diffLong = 123456;
+	reportCycles("multiplyFactorTemperatureDiff", CycleCounter::measure([&]() { sink = multiplyFactorTemperatureDiff(factor, diff); }));
+	reportCycles("multiplyFactorTemperatureDiffLong", CycleCounter::measure([&]() { sink = multiplyFactorTemperatureDiffLong(factor, diffLong); }));
+	reportCycles("constrainTemp16", CycleCounter::measure([&]() { sink = constrainTemp16(diffLong); }));
+
+	// the conversions are inline and must compile to the same code as the macros
+	temperature t = intToTemp(21);
+	temperature_precise precise = tempRegularToPrecise(t) + 12345;
+	uint16_t macroWiden = CycleCounter::measure([&]() { sinkPrecise = tempRegularToPrecise(t); });
+	uint16_t fixedWiden = CycleCounter::measure([&]() { sinkPrecise = Fixed7_9::fromRaw(t).widen<7, 25>().raw(); });
+	uint16_t macroTruncate = CycleCounter::measure([&]() { sink = tempPreciseToRegular(precise); });
+	uint16_t fixedTruncate = CycleCounter::measure([&]() { sink = Fixed7_25::fromRaw(precise).truncate<7, 9>().raw(); });
+	reportCycles("tempRegularToPrecise", macroWiden);
+	reportCycles("Fixed7_9::widen<7, 25>", fixedWiden);
+	reportCycles("tempPreciseToRegular", macroTruncate);
+	reportCycles("Fixed7_25::truncate<7, 9>", fixedTruncate);
+	TEST_ASSERT_EQUAL_UINT16(macroWiden, fixedWiden);
+	TEST_ASSERT_EQUAL_UINT16(macroTruncate, fixedTruncate);
+}
+
+void setup()
+{
+	CycleCounter::begin();
+	UNITY_BEGIN();
+	RUN_TEST(test_integral_saturates);
+	RUN_TEST(test_pid_matches_reference);
+	RUN_TEST(test_pid_cycles);
+	RUN_TEST(test_helper_cycles);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,188 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* CascadedFilterBatch must give exactly the results of CascadedFilter. For b = 0..6, a batch of random walk traces
+ * is filtered by the batch and by one CascadedFilter per trace, and every output is compared.
+ * Run with: pio test -e native -f test_native_filter_batch
+ */
+
+#include "NativeTestSupport.h"
+#include "FilterBatch.h"
+#include "FilterCascaded.h"
+#include <vector>
+#include <unity.h>
+
+static const size_t traces = 64;
+static const uint16_t samples = 5000;
+
+// Random walks that start spread over 0..40 C and move up to 1/8 degree per sample, limited to -10..60 C
+class RandomWalks
+{
+  public:
+	RandomWalks(uint32_t seed) : random(seed), values(traces)
+	{
+		for (size_t i = 0; i < traces; i++)
+		{
+			values[i] = intToTemp(0) + temperature(random.next() % (40 * 512));
+		}
+	}
+
+	const temperature *next()
+	{
+		for (size_t i = 0; i < traces; i++)
+		{
+			temperature step = random.nextInRange(64);
+			if ((values[i] + step) < intToTemp(-10) || (values[i] + step) > intToTemp(60))
+			{
+				step = -step;
+			}
+			values[i] += step;
+		}
+		return values.data();
+	}
+
+	const temperature *current() const
+	{
+		return values.data();
+	}
+
+  private:
+	TestRandom random;
+	std::vector<temperature> values;
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_batch_matches_cascaded_filter(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		RandomWalks walks(b + 1);
+		CascadedFilterBatch batch(traces, b);
+		std::vector<CascadedFilter> filters(traces);
+		std::vector<temperature> outputs(traces);
+
+		batch.init(walks.current());
+		for (size_t i = 0; i < traces; i++)
+		{
+			filters[i].setCoefficients(b);
+			filters[i].init(walks.current()[i]);
+		}
+
+		for (uint16_t n = 0; n < samples; n++)
+		{
+			const temperature *in = walks.next();
+			batch.add(in, outputs.data());
+			for (size_t i = 0; i < traces; i++)
+			{
+				TEST_ASSERT_EQUAL_INT16(filters[i].add(in[i]), outputs[i]);
+				TEST_ASSERT_EQUAL_INT32(filters[i].readOutputDoublePrecision(), batch.readOutputDoublePrecision(i));
+			}
+		}
+	}
+}
+
+void test_batch_double_precision(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		RandomWalks walks(b + 100);
+		CascadedFilterBatch batch(traces);
+		batch.setCoefficients(b);
+		std::vector<CascadedFilter> filters(traces);
+		std::vector<temperature_precise> inputs(traces);
+		std::vector<temperature_precise> outputs(traces);
+
+		batch.init(walks.current());
+		for (size_t i = 0; i < traces; i++)
+		{
+			filters[i].setCoefficients(b);
+			filters[i].init(walks.current()[i]);
+		}
+
+		TestRandom fraction(b);
+		for (uint16_t n = 0; n < samples; n++)
+		{
+			const temperature *in = walks.next();
+			for (size_t i = 0; i < traces; i++)
+			{
+				// use the extra fraction bits too
+				inputs[i] = tempRegularToPrecise(in[i]) + temperature_precise(fraction.next() & 0xFFFF);
+			}
+			batch.addDoublePrecision(inputs.data(), outputs.data());
+			for (size_t i = 0; i < traces; i++)
+			{
+				TEST_ASSERT_EQUAL_INT32(filters[i].addDoublePrecision(inputs[i]), outputs[i]);
+			}
+		}
+	}
+}
+
+void test_batch_timing(void)
+{
+	RandomWalks walks(7);
+	std::vector<std::vector<temperature>> inputs(256);
+	for (size_t n = 0; n < inputs.size(); n++)
+	{
+		const temperature *in = walks.next();
+		inputs[n].assign(in, in + traces);
+	}
+	const uint32_t count = 20000;
+
+	CascadedFilterBatch batch(traces, 4);
+	batch.init(walks.current());
+	double batchNanos = nanosPerCall(count, [&](uint32_t n) { batch.add(inputs[n & 0xFF].data(), NULL); });
+
+	std::vector<CascadedFilter> filters(traces);
+	for (size_t i = 0; i < traces; i++)
+	{
+		filters[i].setCoefficients(4);
+		filters[i].init(walks.current()[i]);
+	}
+	double scalarNanos = nanosPerCall(count, [&](uint32_t n) {
+		for (size_t i = 0; i < traces; i++)
+		{
+			filters[i].add(inputs[n & 0xFF][i]);
+		}
+	});
+
+	reportTiming("CascadedFilterBatch::add, per trace", batchNanos / traces);
+	reportTiming("CascadedFilter::add", scalarNanos / traces);
+}
+
+int main(int argc, char **argv)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_batch_matches_cascaded_filter);
+	RUN_TEST(test_batch_double_precision);
+	RUN_TEST(test_batch_timing);
+	return UNITY_END();
+}
@@ -0,0 +1,465 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* Step, ramp and noise response of FixedFilter, CascadedFilter and TempSensor for b = 0..6.
+ * Checks the delay and settling times documented in FilterFixed.h and FilterCascaded.h, the overshoot and bias,
+ * and the temperature_precise overflow margin, and times add(). Run with: pio test -e native
+ */
+
+#include "NativeTestSupport.h"
+#include "../common/ScriptedTempSensor.h"
+#include "FilterFixed.h"
+#include "FilterCascaded.h"
+#include "TempSensor.h"
+#include <stdlib.h>
+#include <math.h>
+#include <unity.h>
+
+// Documented step response in samples, indexed by b
+static const uint16_t sectionDelay[7] = {3, 6, 13, 26, 53, 107, 214};
+static const uint16_t sectionSettling[7] = {9, 22, 49, 102, 208, 420, 845};
+static const uint16_t cascadedDelay[7] = {9, 20, 43, 88, 179, 360, 723};
+static const uint16_t cascadedSettling[7] = {18, 45, 97, 202, 412, 832, 1672};
+
+// Largest step in whole degrees, centered in the temperature range, for which no intermediate result of the
+// filter equation leaves temperature_precise (FilterFixed.h)
+static const uint8_t overflowFreeStep[7] = {102, 120, 126, 127, 127, 127, 127};
+
+// Truncation in the shifts makes the output settle this much above a constant input, in degrees, at most
+static const double maxSettledOffset = 0.0004;
+
+static const temperature stepLow = intToTemp(20);
+static const temperature stepHigh = intToTemp(30);
+
+struct StepResponse
+{
+	uint16_t delay;	   // outputs before the output reaches half the step
+	uint16_t settling; // index of the last output that is more than 1% of the step away from the end value
+	double overshoot;  // largest distance of the output beyond the end value, in degrees
+	double finalError; // final output minus end value, in degrees
+};
+
+// Initializes the filter to from, then adds to for the given number of samples
+template <class Filter>
+static StepResponse stepResponse(Filter &filter, temperature from, temperature to, uint16_t samples)
+{
+	StepResponse response = {0, 0, 0.0, 0.0};
+	const double precisePerDegree = double(int32_t(1) << 25);
+	const temperature_precise target = tempRegularToPrecise(to);
+	const double step = double(tempRegularToPrecise(to) - tempRegularToPrecise(from));
+	bool reachedHalf = false;
+
+	filter.init(from);
+	for (uint16_t i = 0; i < samples; i++)
+	{
+		filter.add(to);
+		temperature_precise out = filter.readOutputDoublePrecision();
+		double error = double(target) - double(out);
+		double beyond = (step > 0 ? -error : error) / precisePerDegree;
+		if (!reachedHalf && 2 * error / step <= 1)
+		{
+			reachedHalf = true;
+			response.delay = i;
+		}
+		if (fabs(error) * 100 > fabs(step))
+		{
+			response.settling = i;
+		}
+		if (beyond > response.overshoot)
+		{
+			response.overshoot = beyond;
+		}
+		response.finalError = -error / precisePerDegree;
+	}
+	return response;
+}
+
+// Feeds a ramp of one raw unit (1/512 degree) per sample and returns how many samples the output lags behind
+template <class Filter>
+static double rampLag(Filter &filter, uint16_t samples)
+{
+	temperature in = stepLow;
+	filter.init(in);
+	for (uint16_t i = 0; i < samples; i++)
+	{
+		filter.add(++in);
+	}
+	return double(tempRegularToPrecise(in) - filter.readOutputDoublePrecision()) / double(int32_t(1) << 16);
+}
+
+// Ratio of the output RMS noise to the input RMS noise, for uniform noise of +-0.5 degree around 20 degrees
+template <class Filter>
+static double noiseGain(Filter &filter, uint16_t settling, uint16_t samples)
+{
+	TestRandom random;
+	const double center = double(tempRegularToPrecise(stepLow));
+	double inSquares = 0;
+	double outSquares = 0;
+	filter.init(stepLow);
+	for (uint16_t i = 0; i < settling + samples; i++)
+	{
+		temperature in = stepLow + random.nextInRange(256);
+		filter.add(in);
+		if (i >= settling)
+		{
+			double inDiff = double(tempRegularToPrecise(in)) - center;
+			double outDiff = double(filter.readOutputDoublePrecision()) - center;
+			inSquares += inDiff * inDiff;
+			outSquares += outDiff * outDiff;
+		}
+	}
+	return sqrt(outSquares / inSquares);
+}
+
+/* The filter equation of FixedFilter::addDoublePrecision evaluated in 64 bits, one term at a time. Returns the
+ * largest magnitude of any intermediate result, so it can be compared with the temperature_precise range.
+ */
+struct WideSection
+{
+	int64_t xv[3];
+	int64_t yv[3];
+
+	void init(temperature val)
+	{
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			xv[i] = yv[i] = int64_t(val) << 16;
+		}
+	}
+
+	int64_t add(int64_t val, uint8_t b, int64_t &largest)
+	{
+		const uint8_t a = 2 * b + 4;
+		const int64_t terms[] = {-yv[1], yv[0], -(yv[0] >> b), yv[1] >> b, val >> a, xv[0] >> (a - 1), xv[1] >> a, -(yv[1] >> (a - 2))};
+		// after the shift below, yv[0] is yv[1] and yv[1] is yv[2] of the filter equation
+		int64_t sum = yv[0];
+		for (uint8_t i = 0; i < sizeof(terms) / sizeof(terms[0]); i++)
+		{
+			sum += terms[i];
+			largest = llabs(sum) > largest ? llabs(sum) : largest;
+		}
+		xv[2] = xv[1];
+		xv[1] = xv[0];
+		xv[0] = val;
+		yv[2] = yv[1];
+		yv[1] = yv[0];
+		yv[0] = sum;
+		return sum;
+	}
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_fixed_filter_step(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		FixedFilter filter;
+		filter.setCoefficients(b);
+		StepResponse response = stepResponse(filter, stepLow, stepHigh, 4000);
+		TEST_ASSERT_EQUAL_MESSAGE(sectionDelay[b], response.delay, "delay");
+		TEST_ASSERT_EQUAL_MESSAGE(sectionSettling[b], response.settling, "settling");
+		TEST_ASSERT_TRUE_MESSAGE(response.overshoot <= maxSettledOffset, "no overshoot beyond the settled offset");
+		TEST_ASSERT_TRUE_MESSAGE(response.finalError >= 0 && response.finalError <= maxSettledOffset, "settles slightly above the input");
+		TEST_ASSERT_EQUAL_INT16(stepHigh, filter.readOutput());
+	}
+}
+
+void test_cascaded_filter_step(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		CascadedFilter filter;
+		filter.setCoefficients(b);
+		StepResponse response = stepResponse(filter, stepLow, stepHigh, 8000);
+		TEST_ASSERT_EQUAL_MESSAGE(cascadedDelay[b], response.delay, "delay");
+		TEST_ASSERT_EQUAL_MESSAGE(cascadedSettling[b], response.settling, "settling");
+		TEST_ASSERT_TRUE_MESSAGE(response.overshoot <= maxSettledOffset, "no overshoot beyond the settled offset");
+		TEST_ASSERT_TRUE_MESSAGE(response.finalError >= 0 && response.finalError <= maxSettledOffset, "settles slightly above the input");
+		TEST_ASSERT_EQUAL_INT16(stepHigh, filter.readOutput());
+
+		// a step down is the mirror image, apart from the truncation
+		StepResponse down = stepResponse(filter, stepHigh, stepLow, 8000);
+		TEST_ASSERT_INT_WITHIN_MESSAGE(1, response.delay, down.delay, "delay of a step down");
+		TEST_ASSERT_INT_WITHIN_MESSAGE(response.settling / 100 + 1, response.settling, down.settling, "settling of a step down");
+	}
+}
+
+void test_ramp_lag(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		// the lag of one section is 2^(b+2) - 1 samples, the sections add up
+		double expected = double((1 << (b + 2)) - 1);
+		FixedFilter section;
+		section.setCoefficients(b);
+		CascadedFilter cascaded;
+		cascaded.setCoefficients(b);
+		TEST_ASSERT_TRUE_MESSAGE(fabs(rampLag(section, 8000) - expected) <= expected / 100, "ramp lag of one section");
+		TEST_ASSERT_TRUE_MESSAGE(fabs(rampLag(cascaded, 8000) - NUM_SECTIONS * expected) <= expected / 100 * NUM_SECTIONS, "ramp lag of the cascade");
+	}
+}
+
+void test_noise(void)
+{
+	double previous = 0.4;
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		CascadedFilter filter;
+		filter.setCoefficients(b);
+		double gain = noiseGain(filter, cascadedSettling[b] * 2, 20000);
+		char message[60];
+		snprintf(message, sizeof(message), "b=%d: output noise %.4f of input noise", b, gain);
+		TEST_MESSAGE(message);
+		// every step of b halves the bandwidth, which divides the noise by about sqrt(2)
+		TEST_ASSERT_TRUE_MESSAGE(gain < previous * 0.75, message);
+		previous = gain;
+	}
+}
+
+void test_overflow_margin(void)
+{
+	const int64_t preciseMax = INT32_MAX;
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		for (uint8_t size = overflowFreeStep[b]; size <= overflowFreeStep[b] + 1; size++)
+		{
+			// a step of size degrees, centered in the range of temperature
+			const temperature from = -temperature(intToTempDiff(size) / 2);
+			const temperature to = intToTempDiff(size) / 2;
+			for (int8_t direction = -1; direction <= 1; direction += 2)
+			{
+				CascadedFilter filter;
+				filter.setCoefficients(b);
+				filter.init(from * direction);
+				WideSection model[NUM_SECTIONS];
+				for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+				{
+					model[s].init(from * direction);
+				}
+				int64_t largest = 0;
+				for (uint16_t i = 0; i < 4000; i++)
+				{
+					filter.add(to * direction);
+					int64_t val = int64_t(to * direction) << 16;
+					int64_t firstLargest = largest;
+					for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+					{
+						val = model[s].add(val, b, s == 0 ? firstLargest : largest);
+					}
+					largest = firstLargest > largest ? firstLargest : largest;
+					if (size == overflowFreeStep[b])
+					{
+						TEST_ASSERT_EQUAL_INT32_MESSAGE(val, filter.readOutputDoublePrecision(), "filter matches the 64 bit model");
+					}
+				}
+				if (size == overflowFreeStep[b])
+				{
+					TEST_ASSERT_TRUE_MESSAGE(largest <= preciseMax, "no intermediate result overflows");
+				}
+				else if (size < 128)
+				{
+					TEST_ASSERT_TRUE_MESSAGE(largest > preciseMax, "documented margin is the largest one");
+				}
+			}
+		}
+	}
+}
+
+// Compares the constant shift kernel for b == B with the variable shift code of FixedFilter.cpp, on a random walk
+template <uint8_t B>
+static void checkConstantShiftKernel(void)
+{
+	TestRandom random(B + 1);
+	CascadedFilter variable;
+	CascadedFilter constant;
+	variable.setCoefficients(B);
+	constant.setCoefficients(B);
+	variable.init(stepLow);
+	constant.init(stepLow);
+	temperature_precise in = tempRegularToPrecise(stepLow);
+	for (uint16_t i = 0; i < 20000; i++)
+	{
+		in += random.nextInRange(1 << 20);
+		temperature_precise expected = in;
+		for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+		{
+			expected = variable.sections[s].addDoublePrecision(expected);
+		}
+		TEST_ASSERT_EQUAL_INT32(expected, cascadedFilterKernel<B>(constant.sections, in));
+	}
+
+	const uint32_t count = 1000000;
+	char what[60];
+	snprintf(what, sizeof(what), "b=%d, variable shifts", B);
+	reportTiming(what, nanosPerCall(count, [&](uint32_t i) {
+		temperature_precise val = in + (i & 0xFFFF);
+		for (uint8_t s = 0; s < NUM_SECTIONS; s++)
+		{
+			val = variable.sections[s].addDoublePrecision(val);
+		}
+	}));
+	snprintf(what, sizeof(what), "b=%d, constant shifts", B);
+	reportTiming(what, nanosPerCall(count, [&](uint32_t i) { cascadedFilterKernel<B>(constant.sections, in + (i & 0xFFFF)); }));
+}
+
+void test_constant_shift_kernels(void)
+{
+	checkConstantShiftKernel<0>();
+	checkConstantShiftKernel<1>();
+	checkConstantShiftKernel<2>();
+	checkConstantShiftKernel<3>();
+	checkConstantShiftKernel<4>();
+	checkConstantShiftKernel<5>();
+	checkConstantShiftKernel<6>();
+}
+
+void test_temp_sensor_step(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		ScriptedTempSensor input(stepLow);
+		TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &input);
+		sensor.setFastFilterCoefficients(b);
+		sensor.setSlowFilterCoefficients(b);
+		sensor.init();
+		TEST_ASSERT_EQUAL_INT16(stepLow, sensor.readFastFiltered());
+
+		input.value = stepHigh;
+		uint16_t delay = 0;
+		while (sensor.readFastFiltered() < (stepLow + stepHigh) / 2 && delay < 2000)
+		{
+			sensor.update();
+			delay++;
+		}
+		// the outlier filter passes a step (TEMP_SENSOR_OUTLIER_WINDOW - 1) / 2 samples late
+		TEST_ASSERT_EQUAL_MESSAGE(cascadedDelay[b] + 1 + TEMP_SENSOR_OUTLIER_WINDOW / 2, delay, "fast filter delay");
+		TEST_ASSERT_EQUAL_INT16(sensor.readFastFiltered(), sensor.readSlowFiltered());
+	}
+}
+
+void test_temp_sensor_slope(void)
+{
+	for (uint8_t b = 0; b <= 6; b++)
+	{
+		ScriptedTempSensor input(stepLow);
+		TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &input);
+		sensor.setSlowFilterCoefficients(b);
+		sensor.setSlopeFilterCoefficients(b);
+		sensor.init();
+		// 1/512 degree per sample is 3600/512 degree per hour
+		for (uint16_t i = 0; i < 12000; i++)
+		{
+			input.value++;
+			sensor.update();
+		}
+		TEST_ASSERT_INT_WITHIN_MESSAGE(3600 / 50, 3600, sensor.readSlope(), "slope within 2%");
+	}
+}
+
+void test_temp_sensor_noise_and_spikes(void)
+{
+	TestRandom random;
+	ScriptedTempSensor input(stepLow);
+	TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &input);
+	sensor.setFastFilterCoefficients(1);
+	sensor.setSlowFilterCoefficients(4);
+	sensor.init();
+	uint16_t spikes = 0;
+	for (uint16_t i = 0; i < 3000; i++)
+	{
+		input.value = stepLow + random.nextInRange(128); // +-0.25 degree
+#if TEMP_SENSOR_OUTLIER_WINDOW
+		if (i % 100 == 50)
+		{
+			input.value = intToTemp(85); // power-on value of a DS18B20
+			spikes++;
+		}
+#endif
+		sensor.update();
+		TEST_ASSERT_INT_WITHIN_MESSAGE(128, stepLow, sensor.readFastFiltered(), "fast filter stays within the noise");
+		TEST_ASSERT_INT_WITHIN_MESSAGE(16, stepLow, sensor.readSlowFiltered(), "slow filter stays within 1/32 degree");
+	}
+#if TEMP_SENSOR_OUTLIER_WINDOW
+	TEST_ASSERT_EQUAL_UINT16(spikes, sensor.rejectedSamples());
+#else
+	TEST_ASSERT_EQUAL_UINT16(0, spikes);
+#endif
+}
+
+void test_add_timing(void)
+{
+	TestRandom random;
+	temperature inputs[256];
+	for (uint16_t i = 0; i < 256; i++)
+	{
+		inputs[i] = stepLow + random.nextInRange(512);
+	}
+	const uint32_t count = 1000000;
+
+	FixedFilter section;
+	section.init(stepLow);
+	reportTiming("FixedFilter::add", nanosPerCall(count, [&](uint32_t i) { section.add(inputs[i & 0xFF]); }));
+
+	for (uint8_t b = 0; b <= 6; b += 2)
+	{
+		CascadedFilter cascaded;
+		cascaded.setCoefficients(b);
+		cascaded.init(stepLow);
+		char what[40];
+		snprintf(what, sizeof(what), "CascadedFilter::add, b=%d", b);
+		reportTiming(what, nanosPerCall(count, [&](uint32_t i) { cascaded.add(inputs[i & 0xFF]); }));
+	}
+
+	ScriptedTempSensor input(stepLow);
+	TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &input);
+	sensor.init();
+	reportTiming("TempSensor::update", nanosPerCall(count, [&](uint32_t i) {
+		input.value = inputs[i & 0xFF];
+		sensor.update();
+	}));
+}
+
+int main(int argc, char **argv)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_fixed_filter_step);
+	RUN_TEST(test_cascaded_filter_step);
+	RUN_TEST(test_ramp_lag);
+	RUN_TEST(test_noise);
+	RUN_TEST(test_overflow_margin);
+	RUN_TEST(test_constant_shift_kernels);
+	RUN_TEST(test_temp_sensor_step);
+	RUN_TEST(test_temp_sensor_slope);
+	RUN_TEST(test_temp_sensor_noise_and_spikes);
+	RUN_TEST(test_add_timing);
+	return UNITY_END();
+}
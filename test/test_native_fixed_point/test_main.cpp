@@ -0,0 +1,164 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* The Fixed type of FixedPoint.h against the integer code it replaced. The old code is copied here as the
+ * reference. Where results differ on purpose, the tests say so: the PID integral saturates instead of wrapping.
+ * Run with: pio test -e native -f test_native_fixed_point
+ */
+
+#include "NativeTestSupport.h"
+#include "FixedPoint.h"
+#include "TemperatureFormats.h"
+#include <unity.h>
+
+// The helpers of TemperatureFormats.cpp before they used Fixed
+static temperature referenceConstrainTemp16(long_temperature val)
+{
+	if (val < MIN_TEMP)
+	{
+		return MIN_TEMP;
+	}
+	if (val > MAX_TEMP)
+	{
+		return MAX_TEMP;
+	}
+	return val;
+}
+
+static temperature referenceMultiplyFactorTemperatureDiff(temperature factor, temperature b)
+{
+	return referenceConstrainTemp16(((long_temperature)factor * (long_temperature)b) >> TEMP_FIXED_POINT_BITS);
+}
+
+static temperature referenceMultiplyFactorTemperatureDiffLong(temperature factor, long_temperature b)
+{
+	return referenceConstrainTemp16(((long_temperature)factor * b) >> TEMP_FIXED_POINT_BITS);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_limits_keep_invalid_and_disabled_free(void)
+{
+	TEST_ASSERT_EQUAL_INT16(MAX_TEMP, Fixed7_9::maxRaw());
+	TEST_ASSERT_EQUAL_INT16(MIN_TEMP, Fixed7_9::minRaw());
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, Fixed23_9::maxRaw());
+	TEST_ASSERT_EQUAL_INT32(INT32_MIN + 2, Fixed23_9::minRaw());
+}
+
+void test_conversions_match_macros(void)
+{
+	for (int32_t raw = INT16_MIN; raw <= INT16_MAX; raw++)
+	{
+		temperature t = temperature(raw);
+		temperature_precise precise = Fixed7_9::fromRaw(t).widen<7, 25>().raw();
+		TEST_ASSERT_EQUAL_INT32(tempRegularToPrecise(t), precise);
+		temperature back = Fixed7_25::fromRaw(precise).truncate<7, 9>().raw();
+		TEST_ASSERT_EQUAL_INT16(t, back);
+	}
+	TestRandom random;
+	for (uint32_t i = 0; i < 1000000; i++)
+	{
+		temperature_precise precise = temperature_precise(random.next());
+		temperature regular = Fixed7_25::fromRaw(precise).truncate<7, 9>().raw();
+		TEST_ASSERT_EQUAL_INT16(tempPreciseToRegular(precise), regular);
+	}
+	for (int16_t tenths = -700; tenths <= 700; tenths++)
+	{
+		TEST_ASSERT_EQUAL_INT16(doubleToTempDiff(tenths / 10.0), Fixed7_9::fromDouble(tenths / 10.0).raw());
+	}
+}
+
+void test_multiply_and_constrain_match_old_code(void)
+{
+	TestRandom random;
+	for (uint32_t i = 0; i < 1000000; i++)
+	{
+		temperature factor = temperature(random.next());
+		temperature diff = temperature(random.next());
+		long_temperature diffLong = long_temperature(random.next()) >> (random.next() & 15);
+		TEST_ASSERT_EQUAL_INT16(referenceMultiplyFactorTemperatureDiff(factor, diff), multiplyFactorTemperatureDiff(factor, diff));
+		TEST_ASSERT_EQUAL_INT16(referenceMultiplyFactorTemperatureDiffLong(factor, diffLong), multiplyFactorTemperatureDiffLong(factor, diffLong));
+		TEST_ASSERT_EQUAL_INT16(referenceConstrainTemp16(diffLong), constrainTemp16(diffLong));
+	}
+}
+
+void test_saturating_add(void)
+{
+	TEST_ASSERT_EQUAL_INT16(300, Fixed7_9::fromRaw(100).saturatingAdd(Fixed7_9::fromRaw(200)).raw());
+	TEST_ASSERT_EQUAL_INT16(MAX_TEMP, Fixed7_9::fromRaw(MAX_TEMP - 10).saturatingAdd(Fixed7_9::fromRaw(11)).raw());
+	TEST_ASSERT_EQUAL_INT16(MIN_TEMP, Fixed7_9::fromRaw(MIN_TEMP + 10).saturatingAdd(Fixed7_9::fromRaw(-11)).raw());
+	// the sum does not overflow int16_t, but would be INVALID_TEMP
+	TEST_ASSERT_EQUAL_INT16(MIN_TEMP, Fixed7_9::fromRaw(MIN_TEMP).saturatingAdd(Fixed7_9::fromRaw(-2)).raw());
+	TEST_ASSERT_EQUAL_INT16(MIN_TEMP, Fixed7_9::fromRaw(MIN_TEMP).saturatingAdd(Fixed7_9::fromRaw(MIN_TEMP)).raw());
+	TEST_ASSERT_EQUAL_INT16(MAX_TEMP, Fixed7_9::fromRaw(MAX_TEMP).saturatingAdd(Fixed7_9::fromRaw(MAX_TEMP)).raw());
+	TEST_ASSERT_EQUAL_INT16(1, Fixed7_9::fromRaw(MAX_TEMP).saturatingAdd(Fixed7_9::fromRaw(MIN_TEMP)).raw());
+}
+
+/* Behaviour change: the PID integral (updatePID in TempControl.cpp) used to wrap around on int32_t overflow, from
+ * a large positive to a large negative value, which flips the sign of the integral action. It now saturates.
+ */
+void test_integral_saturates_instead_of_wrapping(void)
+{
+	long_temperature integral = INT32_MAX - 50;
+	temperature update = 100;
+	long_temperature wrapped = long_temperature(uint32_t(integral) + uint32_t(update));
+	TEST_ASSERT_TRUE(wrapped < 0); // the old code
+	integral = Fixed23_9::fromRaw(integral).saturatingAdd(Fixed7_9::fromRaw(update).widen<23, 9>()).raw();
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, integral);
+	integral = Fixed23_9::fromRaw(integral).saturatingAdd(Fixed7_9::fromRaw(update).widen<23, 9>()).raw();
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, integral);
+	integral = Fixed23_9::fromRaw(integral).saturatingAdd(Fixed7_9::fromRaw(-update).widen<23, 9>()).raw();
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX - 100, integral);
+
+	integral = INT32_MIN + 50;
+	integral = Fixed23_9::fromRaw(integral).saturatingAdd(Fixed7_9::fromRaw(-update).widen<23, 9>()).raw();
+	TEST_ASSERT_EQUAL_INT32(INT32_MIN + 2, integral);
+
+	// without overflow, the result is the plain sum as before
+	TestRandom random;
+	for (uint32_t i = 0; i < 1000000; i++)
+	{
+		long_temperature a = long_temperature(random.next()) >> 1;
+		temperature b = temperature(random.next());
+		TEST_ASSERT_EQUAL_INT32(a + b, Fixed23_9::fromRaw(a).saturatingAdd(Fixed7_9::fromRaw(b).widen<23, 9>()).raw());
+	}
+}
+
+int main(int argc, char **argv)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_limits_keep_invalid_and_disabled_free);
+	RUN_TEST(test_conversions_match_macros);
+	RUN_TEST(test_multiply_and_constrain_match_old_code);
+	RUN_TEST(test_saturating_add);
+	RUN_TEST(test_integral_saturates_instead_of_wrapping);
+	return UNITY_END();
+}
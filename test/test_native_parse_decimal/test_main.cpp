@@ -0,0 +1,272 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* The decimal parser behind stringToFixedPoint(), stringToTemp() and stringToTempDiff() against an exact reference
+ * in 128-bit integers, on random strings around the valid number syntax and on every exact rounding tie of a
+ * fixed point step in -4..4. The parser it replaced is copied here for the timing comparison.
+ * Run with: pio test -e native -f test_native_parse_decimal
+ */
+
+#include "NativeTestSupport.h"
+#include "TemperatureFormats.h"
+#include <string.h>
+#include <unity.h>
+
+static bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/* The accepted syntax is: spaces, an optional minus sign, digits with an optional decimal point and at least one
+ * digit, spaces. The value is rounded half away from zero to 1/512 and saturated at +-INT32_MAX. At most 30 digits.
+ */
+static bool referenceStringToFixedPoint(long_temperature *result, const char *numberString)
+{
+	const char *p = numberString;
+	while (*p == ' ')
+	{
+		p++;
+	}
+	bool negative = (*p == '-');
+	if (negative)
+	{
+		p++;
+	}
+	__int128 digits = 0;
+	uint8_t count = 0;
+	__int128 scale = 1;
+	for (; isDigit(*p); p++, count++)
+	{
+		digits = digits * 10 + (*p - '0');
+	}
+	if (*p == '.')
+	{
+		for (p++; isDigit(*p); p++, count++)
+		{
+			digits = digits * 10 + (*p - '0');
+			scale *= 10;
+		}
+	}
+	while (*p == ' ')
+	{
+		p++;
+	}
+	if (*p != '\0' || count == 0)
+	{
+		return false;
+	}
+	__int128 rounded = (digits * 2 * (1 << TEMP_FIXED_POINT_BITS) + scale) / (2 * scale);
+	if (rounded > INT32_MAX)
+	{
+		rounded = INT32_MAX;
+	}
+	*result = long_temperature(negative ? -rounded : rounded);
+	return true;
+}
+
+static bool previousInvalidStrtolResult(const char *start, const char *end)
+{
+	return ((*end != '\0' && *end != '.' && *end != ' ') || start == end);
+}
+
+// stringToFixedPoint() before parseDecimal()
+static bool previousStringToFixedPoint(long_temperature *result, const char *numberString)
+{
+	long_temperature newValue;
+	long_temperature decimalValue = 0;
+	const char *decimalPtr;
+	char *end;
+	bool positive = (0 == strchr(numberString, '-'));
+
+	newValue = strtol_impl(numberString, &end);
+	if (previousInvalidStrtolResult(numberString, end))
+	{
+		return false;
+	}
+	newValue = newValue << TEMP_FIXED_POINT_BITS;
+
+	decimalPtr = strchr(numberString, '.');
+	if (decimalPtr != 0)
+	{
+		decimalPtr++;
+		decimalValue = strtol_impl(decimalPtr, &end) << TEMP_FIXED_POINT_BITS;
+		if (previousInvalidStrtolResult(decimalPtr, end))
+		{
+			return false;
+		}
+		uint8_t charsAfterPoint = end - decimalPtr;
+		while (charsAfterPoint-- > 0)
+		{
+			decimalValue = (decimalValue + 5) / 10;
+		}
+	}
+	*result = positive ? newValue + decimalValue : newValue - decimalValue;
+	return true;
+}
+
+// Checks one string against the reference, returns whether it was valid
+static bool checkString(const char *numberString)
+{
+	long_temperature expected = 0x5A5A5A5A;
+	long_temperature result = 0x5A5A5A5A;
+	bool expectedValid = referenceStringToFixedPoint(&expected, numberString);
+	bool valid = stringToFixedPoint(&result, numberString);
+	if (valid != expectedValid || result != expected)
+	{
+		char message[100];
+		snprintf(message, sizeof(message), "'%s': valid %d, expected %d", numberString, valid, expectedValid);
+		TEST_ASSERT_EQUAL_MESSAGE(expectedValid, valid, message);
+		TEST_ASSERT_EQUAL_INT32_MESSAGE(expected, result, message);
+	}
+	return valid;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_examples(void)
+{
+	long_temperature result;
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, " -12.34 "));
+	TEST_ASSERT_EQUAL_INT32(-6318, result); // -12.34 * 512 = -6318.08
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, ".5"));
+	TEST_ASSERT_EQUAL_INT32(256, result);
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, "-.5"));
+	TEST_ASSERT_EQUAL_INT32(-256, result);
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, "5."));
+	TEST_ASSERT_EQUAL_INT32(2560, result);
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, "0.0009765625")); // half a step rounds up
+	TEST_ASSERT_EQUAL_INT32(1, result);
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, "0.00097656249999"));
+	TEST_ASSERT_EQUAL_INT32(0, result);
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, "99999999999999999999999999999"));
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, result);
+	TEST_ASSERT_TRUE(stringToFixedPoint(&result, "-99999999999999999999999999999"));
+	TEST_ASSERT_EQUAL_INT32(-INT32_MAX, result);
+
+	const char *invalid[] = {"", " ", "-", " - ", ".", "-.", "--5", "- 5", "- - 5", "5-", "5 5", "5..1", "5.5.", "1e5", "+5", "0x10", "72. 6", "535.39-8"};
+	for (const char *numberString : invalid)
+	{
+		TEST_ASSERT_FALSE_MESSAGE(stringToFixedPoint(&result, numberString), numberString);
+	}
+}
+
+// Every multiple of 1/1024 is exact with 10 decimals, the odd ones are ties of the 1/512 step
+void test_rounding_ties(void)
+{
+	for (int32_t i = -4 * 1024; i <= 4 * 1024; i++)
+	{
+		char numberString[32];
+		uint32_t magnitude = i < 0 ? -i : i;
+		snprintf(numberString, sizeof(numberString), "%s%u.%010llu", i < 0 ? "-" : "", magnitude / 1024,
+				 (unsigned long long)(magnitude % 1024) * 9765625);
+		TEST_ASSERT_TRUE(checkString(numberString));
+	}
+}
+
+// Random numbers with up to 12 integer digits and 14 decimals, some with a character replaced or inserted
+void test_fuzz(void)
+{
+	const char alphabet[] = " -.+e0123456789";
+	TestRandom random;
+	uint32_t validCount = 0;
+	const uint32_t count = 2000000;
+	for (uint32_t n = 0; n < count; n++)
+	{
+		char numberString[40];
+		uint8_t length = 0;
+		for (uint8_t spaces = random.next() % 3; spaces; spaces--)
+		{
+			numberString[length++] = ' ';
+		}
+		if (random.next() & 1)
+		{
+			numberString[length++] = '-';
+		}
+		for (uint8_t digits = random.next() % 13; digits; digits--)
+		{
+			numberString[length++] = '0' + random.next() % 10;
+		}
+		if (random.next() % 4)
+		{
+			numberString[length++] = '.';
+			for (uint8_t decimals = random.next() % 15; decimals; decimals--)
+			{
+				numberString[length++] = '0' + random.next() % 10;
+			}
+		}
+		for (uint8_t spaces = random.next() % 3; spaces; spaces--)
+		{
+			numberString[length++] = ' ';
+		}
+		numberString[length] = '\0';
+		if (length && random.next() % 4 == 0)
+		{
+			uint8_t position = random.next() % length;
+			char c = alphabet[random.next() % (sizeof(alphabet) - 1)];
+			if (random.next() & 1)
+			{
+				numberString[position] = c;
+			}
+			else
+			{
+				memmove(numberString + position + 1, numberString + position, length - position + 1);
+				numberString[position] = c;
+			}
+		}
+		validCount += checkString(numberString);
+	}
+	char message[80];
+	snprintf(message, sizeof(message), "%u of %u strings were valid", validCount, count);
+	TEST_MESSAGE(message);
+}
+
+void test_timing(void)
+{
+	char numberStrings[1000][12];
+	for (int16_t i = 0; i < 1000; i++)
+	{
+		snprintf(numberStrings[i], sizeof(numberStrings[i]), "%d.%02d", i / 10 - 50, i % 100);
+	}
+	long_temperature result;
+	reportTiming("stringToFixedPoint before parseDecimal",
+				 nanosPerCall(1000000, [&](uint32_t i) { previousStringToFixedPoint(&result, numberStrings[i % 1000]); }));
+	reportTiming("stringToFixedPoint", nanosPerCall(1000000, [&](uint32_t i) { stringToFixedPoint(&result, numberStrings[i % 1000]); }));
+}
+
+int main(int argc, char **argv)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_examples);
+	RUN_TEST(test_rounding_ties);
+	RUN_TEST(test_fuzz);
+	RUN_TEST(test_timing);
+	return UNITY_END();
+}
@@ -0,0 +1,242 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* Lag and noise of the slope estimate of TempSensor: the slope filter (settings 0..7) against the least squares
+ * fit of LeastSquaresSlope (settings 8 and up).
+ *
+ * The input is synthetic, not recorded: the repository has no sensor logs. It models a DS18B20 read every second:
+ * a slow temperature ramp plus noise, quantized to 1/16 degree.
+ * Run with: pio test -e native -f test_native_slope
+ */
+
+#include "NativeTestSupport.h"
+#include "../common/ScriptedTempSensor.h"
+#include "FilterLeastSquares.h"
+#include "TempSensor.h"
+#include <stdlib.h>
+#include <math.h>
+#include <unity.h>
+
+/* Synthetic readings: 20 C until rampStart, then a ramp of slope degrees per hour, plus noise with a standard
+ * deviation of noise degrees. Quantized to 1/16 degree like a DS18B20, or to the 1/512 degree of temperature.
+ */
+class SyntheticSensorData
+{
+  public:
+	SyntheticSensorData(double slope, double noise, bool ds18b20, uint32_t rampStart, uint32_t seed = 1)
+		: slope(slope), noise(noise), step(ds18b20 ? 32 : 1), rampStart(rampStart), random(seed)
+	{
+	}
+
+	temperature at(uint32_t second)
+	{
+		double t = 20.0;
+		if (second > rampStart)
+		{
+			t += slope * (second - rampStart) / 3600.0;
+		}
+		// sum of 4 uniform values, close to a normal distribution with standard deviation 1
+		double normal = 0;
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			normal += (random.next() / 4294967296.0 - 0.5) * sqrt(12.0) / 2;
+		}
+		t += normal * noise;
+		return intToTemp(0) + temperature(floor(t * 512 / step) * step);
+	}
+
+  private:
+	double slope;
+	double noise;
+	uint8_t step;
+	uint32_t rampStart;
+	TestRandom random;
+};
+
+struct SlopeStatistics
+{
+	uint32_t lag;	 // seconds after the ramp starts until the estimate last crosses half the slope
+	double rmsError; // of the estimate during the ramp, after it settled, in degrees per hour
+};
+
+static SlopeStatistics measureSlope(uint8_t setting, double slope, double noise, bool ds18b20)
+{
+	const uint32_t rampStart = 3 * 3600;
+	const uint32_t end = rampStart + 10 * 3600;
+	const uint32_t settled = rampStart + 4 * 3600;
+	SyntheticSensorData data(slope, noise, ds18b20, rampStart);
+	ScriptedTempSensor input(data.at(0));
+	TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &input);
+	sensor.setFastFilterCoefficients(0); // ramp lag (2^2 - 1) * 3 sections = 9 s
+	sensor.setSlowFilterCoefficients(4);
+	sensor.setSlopeFilterCoefficients(setting);
+	sensor.init();
+
+	SlopeStatistics statistics = {0, 0.0};
+	double squares = 0;
+	uint32_t count = 0;
+	for (uint32_t second = 1; second < end; second++)
+	{
+		input.value = data.at(second);
+		sensor.update();
+		double estimate = sensor.readSlope() / 512.0;
+		if (second > rampStart && second < settled && estimate < slope / 2)
+		{
+			statistics.lag = second + 1 - rampStart;
+		}
+		if (second >= settled)
+		{
+			squares += (estimate - slope) * (estimate - slope);
+			count++;
+		}
+	}
+	statistics.rmsError = sqrt(squares / count);
+	return statistics;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// On a noise free ramp the fit is exact once the window is filled
+void test_least_squares_exact_on_ramp(void)
+{
+	const uint16_t windows[] = {8, 32, 33, 60, 120, 600, 1020, 3600, 8160};
+	for (uint8_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++)
+	{
+		for (int8_t rawPerSecond = -2; rawPerSecond <= 2; rawPerSecond++)
+		{
+			LeastSquaresSlope fit;
+			fit.setWindow(windows[w]);
+			TEST_ASSERT_EQUAL_UINT16(windows[w], fit.getWindow());
+			temperature value = intToTemp(20);
+			fit.init(value);
+			TEST_ASSERT_EQUAL_INT16(0, fit.readSlope());
+			for (uint16_t i = 0; i < windows[w] + 255; i++) // fills the window, whatever the interval
+			{
+				value += rawPerSecond;
+				fit.add(value);
+			}
+			TEST_ASSERT_EQUAL_INT16(rawPerSecond * 3600, fit.readSlope());
+		}
+	}
+}
+
+void test_least_squares_saturates(void)
+{
+	LeastSquaresSlope fit;
+	fit.setWindow(8);
+	fit.init(intToTemp(0));
+	temperature value = intToTemp(0);
+	for (uint8_t i = 0; i < 16; i++)
+	{
+		value += 512; // 1 degree per second is 3600 degrees per hour
+		fit.add(value);
+	}
+	TEST_ASSERT_EQUAL_INT16(MAX_TEMP, fit.readSlope());
+}
+
+void test_temp_sensor_allocates_fit(void)
+{
+	ScriptedTempSensor input(intToTemp(20));
+	TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &input);
+	sensor.init();
+	sensor.setSlopeFilterCoefficients(TEMP_SENSOR_SLOPE_REGRESSION_SETTING);
+	for (uint16_t i = 0; i < 600; i++)
+	{
+		input.value++;
+		sensor.update();
+	}
+	// the fit follows the fast filter, which passes a ramp of 1/512 degree per second after a short delay
+	TEST_ASSERT_INT_WITHIN(1, 3600, sensor.readSlope());
+
+	// back to the slope filter, the fit is freed
+	sensor.setSlopeFilterCoefficients(3);
+	sensor.setSlopeFilterCoefficients(TEMP_SENSOR_SLOPE_REGRESSION_SETTING + 2);
+}
+
+/* Lag is measured on a steep ramp without noise or DS18B20 quantization, the error of the settled estimate on a
+ * slow ramp with both.
+ * The slope filter is included for comparison and only has to settle.
+ */
+void test_lag_and_noise(void)
+{
+	const double slope = 0.5;	  // degrees per hour, a typical fermentation rise
+	const double noise = 0.02;	  // degrees, a DS18B20 in a thermowell
+	const double steepSlope = 18; // for the lag, 2.5 steps of 1/512 degree per second
+	const uint8_t settings[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 16, 32, 64, 128, 255};
+	double previousError = 1000;
+	for (uint8_t i = 0; i < sizeof(settings); i++)
+	{
+		uint8_t setting = settings[i];
+		bool leastSquares = setting >= TEMP_SENSOR_SLOPE_REGRESSION_SETTING;
+		uint32_t lag = measureSlope(setting, steepSlope, 0.0, false).lag;
+		double rmsError = measureSlope(setting, slope, noise, true).rmsError;
+		char message[100];
+		snprintf(message, sizeof(message), "setting %3d, %s: lag %4lu s, rms error %.3f degree/hour", setting,
+				 leastSquares ? "least squares" : "slope filter ", (unsigned long)lag, rmsError);
+		TEST_MESSAGE(message);
+		TEST_ASSERT_TRUE_MESSAGE(lag > 0 && lag < 4 * 3600, message);
+		if (leastSquares)
+		{
+			uint32_t window = setting * TEMP_SENSOR_SLOPE_REGRESSION_SCALE;
+			uint32_t interval = (window + LeastSquaresSlope::MAX_POINTS - 1) / LeastSquaresSlope::MAX_POINTS;
+			// the fit lags half its window, plus up to one point and the ramp lag of the fast filter
+			TEST_ASSERT_TRUE_MESSAGE(lag >= window / 2, message);
+			TEST_ASSERT_TRUE_MESSAGE(lag <= window / 2 + interval + 9 + 1 + TEMP_SENSOR_OUTLIER_WINDOW / 2, message);
+			// a longer window gives a less noisy estimate
+			TEST_ASSERT_TRUE_MESSAGE(rmsError < previousError, message);
+			previousError = rmsError;
+		}
+	}
+}
+
+void test_timing(void)
+{
+	LeastSquaresSlope fit;
+	fit.setWindow(1020);
+	fit.init(intToTemp(20));
+	reportTiming("LeastSquaresSlope::add", nanosPerCall(1000000, [&](uint32_t i) { fit.add(intToTemp(20) + (i & 0xFF)); }));
+	reportTiming("LeastSquaresSlope::readSlope", nanosPerCall(1000000, [&](uint32_t i) {
+		fit.add(intToTemp(20) + (i & 0xFF));
+		volatile temperature slope = fit.readSlope();
+		(void)slope;
+	}));
+}
+
+int main(int argc, char **argv)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_least_squares_exact_on_ramp);
+	RUN_TEST(test_least_squares_saturates);
+	RUN_TEST(test_temp_sensor_allocates_fit);
+	RUN_TEST(test_lag_and_noise);
+	RUN_TEST(test_timing);
+	return UNITY_END();
+}
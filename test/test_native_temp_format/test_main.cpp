@@ -0,0 +1,161 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/* The printf free number formatting of TemperatureFormats.cpp against the vsnprintf_P code it replaced, kept in
+ * test/common as the reference. Every raw value is checked, in C and F, for 1..3 decimals and several maxLength
+ * values, comparing the whole buffer so no extra bytes may be written. The LCD timer string is checked too.
+ * Run with: pio test -e native -f test_native_temp_format
+ */
+
+#include "NativeTestSupport.h"
+#include "../common/ReferenceFormats.h"
+#include "TemperatureFormats.h"
+#include <string.h>
+#include <unity.h>
+
+// The LCD state timer of DisplayLcd.cpp before, with DISPLAY_TIME_HMS
+static const char *referenceTimeString(char *timeString, uint16_t time)
+{
+	unsigned int minutes = time / 60;
+	unsigned int hours = minutes / 60;
+	sprintf_P(timeString, PSTR("%dh%02dm%02d"), hours, minutes % 60, time % 60);
+	return hours ? timeString : &timeString[2];
+}
+
+// The code in LcdDisplay::printState(), which cannot run without an LCD
+static const char *timeString(char *timeString, uint16_t time)
+{
+	unsigned int minutes = time / 60;
+	unsigned int hours = minutes / 60;
+	char *end = timeString;
+	if (hours)
+	{
+		end = uintToString(end, hours, 1);
+		*end++ = 'h';
+	}
+	end = uintToString(end, minutes % 60, 2);
+	*end++ = 'm';
+	uintToString(end, time % 60, 2);
+	return timeString;
+}
+
+static const uint8_t bufferSize = 32;
+static const uint8_t maxLengths[] = {6, 7, 8, 9, 12};
+
+typedef char *(*FormatFunction)(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength);
+
+static char *fixedPointToStringShort(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
+{
+	return fixedPointToString(s, temperature(rawValue), numDecimals, maxLength);
+}
+
+static uint32_t compareAllValues(FormatFunction function, FormatFunction reference, const char *name)
+{
+	uint32_t cases = 0;
+	for (char format = 'C'; format != 0; format = (format == 'C') ? 'F' : 0)
+	{
+		TempControl::cc.tempFormat = format;
+		for (int32_t raw = INT16_MIN; raw <= INT16_MAX; raw++)
+		{
+			for (uint8_t numDecimals = 1; numDecimals <= 3; numDecimals++)
+			{
+				for (uint8_t m = 0; m < sizeof(maxLengths); m++)
+				{
+					char expected[bufferSize];
+					char result[bufferSize];
+					memset(expected, 0x55, bufferSize);
+					memset(result, 0x55, bufferSize);
+					reference(expected, raw, numDecimals, maxLengths[m]);
+					function(result, raw, numDecimals, maxLengths[m]);
+					if (memcmp(expected, result, bufferSize) != 0)
+					{
+						char message[160];
+						snprintf(message, sizeof(message), "%s(%d) in %c, %d decimals, maxLength %d: \"%s\" instead of \"%s\"",
+								 name, int(raw), format, numDecimals, maxLengths[m], result, expected);
+						TEST_FAIL_MESSAGE(message);
+					}
+					cases++;
+				}
+			}
+		}
+	}
+	return cases;
+}
+
+void setUp(void)
+{
+	TempControl::cc.tempFormat = 'C';
+}
+
+void tearDown(void) {}
+
+void test_temp_to_string(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(2 * 65536 * 3 * sizeof(maxLengths), compareAllValues(tempToString, referenceTempToString, "tempToString"));
+}
+
+void test_temp_diff_to_string(void)
+{
+	compareAllValues(tempDiffToString, referenceTempDiffToString, "tempDiffToString");
+}
+
+void test_fixed_point_to_string(void)
+{
+	compareAllValues(fixedPointToStringShort, referenceFixedPointToString, "fixedPointToString");
+}
+
+void test_lcd_time_string(void)
+{
+	for (uint16_t time = 0; time < UINT16_MAX; time++) // UINT16_MAX means no timer
+	{
+		char expected[bufferSize];
+		char result[bufferSize];
+		TEST_ASSERT_EQUAL_STRING(referenceTimeString(expected, time), timeString(result, time));
+	}
+}
+
+void test_timing(void)
+{
+	char buffer[bufferSize];
+	reportTiming("tempToString, printf", nanosPerCall(1000000, [&](uint32_t i) { referenceTempToString(buffer, intToTemp(0) + temperature(i), 2, 12); }));
+	reportTiming("tempToString", nanosPerCall(1000000, [&](uint32_t i) { tempToString(buffer, intToTemp(0) + temperature(i), 2, 12); }));
+	reportTiming("LCD timer, sprintf", nanosPerCall(1000000, [&](uint32_t i) { referenceTimeString(buffer, uint16_t(i)); }));
+	reportTiming("LCD timer", nanosPerCall(1000000, [&](uint32_t i) { timeString(buffer, uint16_t(i)); }));
+}
+
+int main(int argc, char **argv)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_temp_to_string);
+	RUN_TEST(test_temp_diff_to_string);
+	RUN_TEST(test_fixed_point_to_string);
+	RUN_TEST(test_lcd_time_string);
+	RUN_TEST(test_timing);
+	return UNITY_END();
+}
@@ -72,7 +72,8 @@ check_root() {
 get_envs() {
     echo -e "\nGathering build environments for $GITNAME."
     cd "$GITROOT" || exit
-    readarray -t ENVIRONMENTS < <("$PIO" project data | grep "env_name" | cut -d'"' -f2)
+    # The native and bench environments only run tests, they have no firmware to release
+    readarray -t ENVIRONMENTS < <("$PIO" project data | grep "env_name" | cut -d'"' -f2 | grep -v -E "^(native|bench)$")
 }
 
 list_envs() {
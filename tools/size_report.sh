@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+
+# Copyright (C) 2018, 2019 Lee C. Bussy (@LBussy)
+
+# This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+# BrewPi Firmware RMX is free software: you can redistribute it and/or
+# modify it under the terms of the GNU General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+
+# BrewPi Firmware RMX is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+
+# Prints the flash and RAM use of the RevC firmware, built with the default
+# configuration and with each set of extra defines given as an argument:
+#
+#   tools/size_report.sh "-D BREWPI_TELEMETRY_PUSH=0" "-D FILTER_CONSTANT_SHIFTS=0"
+#
+# With --features, each optional feature is toggled from its default in turn:
+#
+#   tools/size_report.sh --features
+#
+# With --symbols, the default configuration is built and the flash size of
+# each function whose name matches one of the patterns is printed:
+#
+#   tools/size_report.sh --symbols updatePID multiplyFactor
+#
+# Flash is text + data, RAM is data + bss. RAM does not include the stack,
+# which gets what is left of the 2048 bytes. Optiboot leaves 32256 bytes of
+# flash for the firmware.
+
+ENV="RevC"
+FLASH_SIZE=32256
+RAM_SIZE=2048
+PIO="${PIO:-$HOME/.platformio/penv/bin/platformio}"
+AVR_SIZE="${AVR_SIZE:-$HOME/.platformio/packages/toolchain-atmelavr/bin/avr-size}"
+AVR_NM="${AVR_NM:-$HOME/.platformio/packages/toolchain-atmelavr/bin/avr-nm}"
+
+build_size() {
+    local flags="$1" elf sizes text data bss
+    if ! PLATFORMIO_BUILD_FLAGS="$flags" "$PIO" run -s -e "$ENV" > /dev/null; then
+        printf "%-45s build failed\n" "${flags:-default}"
+        return
+    fi
+    elf=$(ls -t .pio/build/"$ENV"/*.elf | head -n 1)
+    # avr-size prints: text data bss dec hex filename
+    sizes=$("$AVR_SIZE" "$elf" | tail -n 1)
+    read -r text data bss _ <<< "$sizes"
+    printf "%-45s flash %6d (%d free)   RAM %5d (%d left for the stack)\n" \
+        "${flags:-default}" $((text + data)) $((FLASH_SIZE - text - data)) \
+        $((data + bss)) $((RAM_SIZE - data - bss))
+}
+
+# Each entry toggles one feature from its default in AppConfigDefault.h
+FEATURES=(
+    "-D BREWPI_TELEMETRY_PUSH=0"
+    "-D BREWPI_COMPACT_TELEMETRY=0"
+    "-D BREWPI_FULL_STATE_COMMAND=0"
+    "-D BREWPI_BINARY_PILINK=1"
+    "-D BREWPI_TEMP_HISTORY=1"
+    "-D BREWPI_LOOP_PROFILER=1"
+    "-D LOG_QUEUE_SIZE=0"
+    "-D LOG_RATE_LIMIT=0"
+    "-D TEMP_SENSOR_OUTLIER_WINDOW=0"
+    "-D TEMP_SENSOR_PEAK_DETECTOR=0"
+    "-D TEMP_SENSOR_SLOPE_REGRESSION=0"
+    "-D FILTER_CONSTANT_SHIFTS=0"
+)
+
+symbol_sizes() {
+    local elf pattern
+    if ! "$PIO" run -s -e "$ENV" > /dev/null; then
+        echo "build failed"
+        return
+    fi
+    elf=$(ls -t .pio/build/"$ENV"/*.elf | head -n 1)
+    for pattern in "$@"; do
+        # avr-nm prints: address size type name
+        "$AVR_NM" -S -C --size-sort "$elf" | grep -e "$pattern" | while read -r _ size _ name; do
+            printf "%6d  %s\n" $((16#$size)) "$name"
+        done
+    done
+}
+
+cd "$(git rev-parse --show-toplevel)" || exit 1
+if [ "$1" == "--symbols" ]; then
+    shift
+    symbol_sizes "$@"
+    exit
+fi
+if [ "$1" == "--features" ]; then
+    shift
+    set -- "${FEATURES[@]}" "$@"
+fi
+build_size ""
+for flags in "$@"; do
+    build_size "$flags"
+done